@@ -16,7 +16,7 @@ TEMPLATE = app
 CONFIG += c++14
 
 # additional modules are pulled in via arcgisruntime.pri
-QT += opengl qml quick quickcontrols2 network
+QT += opengl qml quick quickcontrols2 network concurrent
 
 TARGET = GEOINTMonitor
 
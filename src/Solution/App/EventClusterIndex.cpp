@@ -0,0 +1,193 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "EventClusterIndex.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+namespace
+{
+// Cell sizes from 16 meters up to 16 777 216 meters
+const int MinLevel = 4;
+const int MaxLevel = 24;
+
+// Grid origin of the Web Mercator world extent
+const double GridOrigin = 20037508.342789244;
+}
+
+EventClusterIndex::EventClusterIndex() :
+    m_cellsByLevel(MaxLevel - MinLevel + 1)
+{
+}
+
+void EventClusterIndex::insert(const QString &id, const QPointF &location)
+{
+    if (m_slotsById.contains(id))
+    {
+        return;
+    }
+
+    quint32 slot = 0;
+    if (m_freeSlots.isEmpty())
+    {
+        slot = quint32(m_slots.count());
+        m_slots.append(Slot());
+    }
+    else
+    {
+        slot = m_freeSlots.takeLast();
+    }
+
+    m_slots[int(slot)].id = id;
+    m_slots[int(slot)].location = location;
+    m_slotsById.insert(id, slot);
+    updateCells(slot, 1);
+}
+
+void EventClusterIndex::remove(const QString &id)
+{
+    if (!m_slotsById.contains(id))
+    {
+        return;
+    }
+
+    quint32 slot = m_slotsById.take(id);
+    updateCells(slot, -1);
+    m_slots[int(slot)].id.clear();
+    m_freeSlots.append(slot);
+}
+
+void EventClusterIndex::clear()
+{
+    for (int levelIndex = 0; levelIndex < m_cellsByLevel.count(); levelIndex++)
+    {
+        m_cellsByLevel[levelIndex].clear();
+    }
+    m_slots.clear();
+    m_freeSlots.clear();
+    m_slotsById.clear();
+}
+
+int EventClusterIndex::count() const
+{
+    return m_slotsById.count();
+}
+
+QList<EventClusterIndex::Cluster> EventClusterIndex::clusters(double cellSize, const QRectF &extent) const
+{
+    QList<Cluster> clusters;
+    int level = levelForCellSize(cellSize);
+    double levelCellSize = cellSizeOfLevel(level);
+    const QHash<quint64, Cell>& cells = m_cellsByLevel[level - MinLevel];
+
+    qint64 minColumn = qFloor((extent.left() + GridOrigin) / levelCellSize);
+    qint64 maxColumn = qFloor((extent.right() + GridOrigin) / levelCellSize);
+    qint64 minRow = qFloor((extent.top() + GridOrigin) / levelCellSize);
+    qint64 maxRow = qFloor((extent.bottom() + GridOrigin) / levelCellSize);
+    qint64 extentCellCount = (maxColumn - minColumn + 1) * (maxRow - minRow + 1);
+
+    auto appendCluster = [&clusters, levelCellSize, this](qint64 column, qint64 row, const Cell& cell)
+    {
+        Cluster cluster;
+        cluster.cellBounds = QRectF(column * levelCellSize - GridOrigin, row * levelCellSize - GridOrigin, levelCellSize, levelCellSize);
+        cluster.center = QPointF(cell.sumX / cell.count, cell.sumY / cell.count);
+        cluster.count = cell.count;
+        if (1 == cell.count)
+        {
+            cluster.id = m_slots[int(cell.slotXor)].id;
+        }
+        clusters.append(cluster);
+    };
+
+    if (extentCellCount < cells.count())
+    {
+        // Visit the cells covering the extent
+        for (qint64 row = minRow; row <= maxRow; row++)
+        {
+            for (qint64 column = minColumn; column <= maxColumn; column++)
+            {
+                auto cellIterator = cells.constFind(cellKey(column, row));
+                if (cellIterator != cells.constEnd())
+                {
+                    appendCluster(column, row, cellIterator.value());
+                }
+            }
+        }
+    }
+    else
+    {
+        // Visit the occupied cells
+        for (auto cellIterator = cells.constBegin(); cellIterator != cells.constEnd(); ++cellIterator)
+        {
+            qint64 column = qint64(cellIterator.key() >> 32);
+            qint64 row = qint64(cellIterator.key() & 0xffffffff);
+            if (minColumn <= column && column <= maxColumn && minRow <= row && row <= maxRow)
+            {
+                appendCluster(column, row, cellIterator.value());
+            }
+        }
+    }
+
+    return clusters;
+}
+
+int EventClusterIndex::levelForCellSize(double cellSize)
+{
+    int level = qCeil(std::log2(qMax(1.0, cellSize)));
+    return qBound(MinLevel, level, MaxLevel);
+}
+
+double EventClusterIndex::cellSizeOfLevel(int level)
+{
+    return std::ldexp(1.0, level);
+}
+
+quint64 EventClusterIndex::cellKey(qint64 column, qint64 row)
+{
+    return (quint64(column) << 32) | (quint64(row) & 0xffffffff);
+}
+
+void EventClusterIndex::updateCells(quint32 slot, int countDelta)
+{
+    const QPointF& location = m_slots[int(slot)].location;
+    for (int level = MinLevel; level <= MaxLevel; level++)
+    {
+        double levelCellSize = cellSizeOfLevel(level);
+        qint64 column = qFloor((location.x() + GridOrigin) / levelCellSize);
+        qint64 row = qFloor((location.y() + GridOrigin) / levelCellSize);
+        quint64 key = cellKey(column, row);
+
+        QHash<quint64, Cell>& cells = m_cellsByLevel[level - MinLevel];
+        Cell& cell = cells[key];
+        cell.count += countDelta;
+        cell.sumX += countDelta * location.x();
+        cell.sumY += countDelta * location.y();
+        cell.slotXor ^= slot;
+        if (cell.count <= 0)
+        {
+            cells.remove(key);
+        }
+    }
+}
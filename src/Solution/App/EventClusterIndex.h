@@ -0,0 +1,91 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef EVENTCLUSTERINDEX_H
+#define EVENTCLUSTERINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+
+// Grid clusters of point locations being maintained for every power of two cell size.
+// Inserting and removing a location updates one cell per level, so changing the scale
+// only needs to read the cells of one level.
+class EventClusterIndex
+{
+public:
+    struct Cluster
+    {
+        QRectF cellBounds;
+        QPointF center;
+        int count = 0;
+
+        // Only set for clusters of one location
+        QString id;
+    };
+
+    EventClusterIndex();
+
+    void insert(const QString& id, const QPointF& location);
+
+    void remove(const QString& id);
+
+    void clear();
+
+    int count() const;
+
+    QList<Cluster> clusters(double cellSize, const QRectF& extent) const;
+
+private:
+    struct Cell
+    {
+        int count = 0;
+        double sumX = 0;
+        double sumY = 0;
+
+        // XOR of the slots in this cell equals the only slot when count is one
+        quint32 slotXor = 0;
+    };
+
+    struct Slot
+    {
+        QString id;
+        QPointF location;
+    };
+
+    static int levelForCellSize(double cellSize);
+    static double cellSizeOfLevel(int level);
+    static quint64 cellKey(qint64 column, qint64 row);
+
+    void updateCells(quint32 slot, int countDelta);
+
+    QVector<QHash<quint64, Cell>> m_cellsByLevel;
+    QVector<Slot> m_slots;
+    QVector<quint32> m_freeSlots;
+    QHash<QString, quint32> m_slotsById;
+};
+
+#endif // EVENTCLUSTERINDEX_H
@@ -0,0 +1,116 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "FeatureParsePipeline.h"
+
+#include <QFutureWatcher>
+#include <QNetworkReply>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+FeatureParsePipeline::FeatureParsePipeline(QObject *parent) :
+    QObject(parent),
+    m_currentGeneration(new QAtomicInteger<quint64>(0))
+{
+}
+
+quint64 FeatureParsePipeline::supersede()
+{
+    // Running jobs of older generations are canceled and their results are dropped
+    quint64 generation = m_currentGeneration->fetchAndAddOrdered(1) + 1;
+
+    // Aborting emits finished, the owners drop these replies as they are no longer current
+    QList<QNetworkReply*> supersededReplies = m_runningReplies.keys();
+    m_runningReplies.clear();
+    foreach (QNetworkReply* supersededReply, supersededReplies)
+    {
+        supersededReply->abort();
+    }
+
+    return generation;
+}
+
+quint64 FeatureParsePipeline::generation() const
+{
+    return m_currentGeneration->load();
+}
+
+bool FeatureParsePipeline::isCurrent(quint64 generation) const
+{
+    return generation == m_currentGeneration->load();
+}
+
+void FeatureParsePipeline::trackRequest(QNetworkRequest &request, quint64 generation)
+{
+    request.setAttribute(QNetworkRequest::User, generation);
+}
+
+void FeatureParsePipeline::trackReply(QNetworkReply *reply)
+{
+    quint64 generation = requestGeneration(reply);
+    if (!isCurrent(generation))
+    {
+        reply->abort();
+        return;
+    }
+
+    m_runningReplies.insert(reply, generation);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]()
+    {
+        m_runningReplies.remove(reply);
+    });
+}
+
+quint64 FeatureParsePipeline::requestGeneration(const QNetworkReply *reply)
+{
+    return reply->request().attribute(QNetworkRequest::User).toULongLong();
+}
+
+void FeatureParsePipeline::submit(quint64 generation, const ParseJob &job, int sourceId)
+{
+    QSharedPointer<QAtomicInteger<quint64>> currentGeneration = m_currentGeneration;
+    CancelCheck isCanceled = [currentGeneration, generation]()
+    {
+        return generation != currentGeneration->load();
+    };
+
+    // Parse on the worker pool and hand the features over on the GUI thread
+    QFutureWatcher<ParsedFeatureList>* parseWatcher = new QFutureWatcher<ParsedFeatureList>(this);
+    connect(parseWatcher, &QFutureWatcherBase::finished, this, [this, parseWatcher, generation, sourceId]()
+    {
+        ParsedFeatureList features = parseWatcher->result();
+        parseWatcher->deleteLater();
+        if (isCurrent(generation))
+        {
+            emit featuresParsed(generation, features, sourceId);
+        }
+    });
+    parseWatcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(), [job, isCanceled]()
+    {
+        if (isCanceled())
+        {
+            return ParsedFeatureList();
+        }
+        return job(isCanceled);
+    }));
+}
@@ -0,0 +1,69 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef FEATUREPARSEPIPELINE_H
+#define FEATUREPARSEPIPELINE_H
+
+#include "ParsedFeature.h"
+
+class QNetworkReply;
+
+#include <QAtomicInteger>
+#include <QHash>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QSharedPointer>
+
+class FeatureParsePipeline : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<ParsedFeatureList(const CancelCheck&)> ParseJob;
+
+    explicit FeatureParsePipeline(QObject *parent = nullptr);
+
+    quint64 supersede();
+
+    quint64 generation() const;
+
+    bool isCurrent(quint64 generation) const;
+
+    void trackRequest(QNetworkRequest& request, quint64 generation);
+    void trackReply(QNetworkReply* reply);
+
+    static quint64 requestGeneration(const QNetworkReply* reply);
+
+    void submit(quint64 generation, const ParseJob& job, int sourceId = 0);
+
+signals:
+    void featuresParsed(quint64 generation, const ParsedFeatureList& features, int sourceId);
+
+private:
+    // Shared with the running jobs so that they can detect being superseded
+    QSharedPointer<QAtomicInteger<quint64>> m_currentGeneration;
+
+    // Network replies still loading by their generation
+    QHash<QNetworkReply*, quint64> m_runningReplies;
+};
+
+#endif // FEATUREPARSEPIPELINE_H
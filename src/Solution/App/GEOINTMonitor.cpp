@@ -15,24 +15,29 @@
 
 #include "GdeltCalloutData.h"
 #include "GdeltEventLayer.h"
+#include "GraphicHitIndex.h"
 #include "NominatimPlaceLayer.h"
+#include "ResponseCache.h"
 #include "SimpleGeoJsonLayer.h"
 #include "WikimapiaPlaceLayer.h"
 
 #include "Basemap.h"
 #include "GeometryEngine.h"
 #include "Graphic.h"
-#include "IdentifyGraphicsOverlayResult.h"
 #include "Map.h"
 #include "MapQuickView.h"
 #include "Point.h"
+#include "Polygon.h"
 
 #include <QClipboard>
 #include <QDesktopServices>
 #include <QDir>
+#include <QFileInfo>
 #include <QGuiApplication>
 #include <QRegularExpression>
+#include <QStandardPaths>
 #include <QStringBuilder>
+#include <QtMath>
 #include <QUrl>
 
 using namespace Esri::ArcGISRuntime;
@@ -40,11 +45,33 @@ using namespace Esri::ArcGISRuntime;
 GEOINTMonitor::GEOINTMonitor(QObject* parent /* = nullptr */):
     QObject(parent),
     m_map(new Map(Basemap::openStreetMap(this), this)),
+    m_responseCache(new ResponseCache(this)),
     m_gdeltLayer(new GdeltEventLayer(this)),
     m_nominatimPlaceLayer(new NominatimPlaceLayer(this)),
     m_geoJsonLayer(new SimpleGeoJsonLayer(this)),
-    m_wikimapiaPlaceLayer(new WikimapiaPlaceLayer(this))
+    m_wikimapiaPlaceLayer(new WikimapiaPlaceLayer(this)),
+    m_hitIndex(new GraphicHitIndex(this)),
+    m_liveTimer(new QTimer(this))
 {
+    // GDELT updates every 15 minutes, places rarely change
+    const qint64 secondsPerDay = 24 * 60 * 60;
+    m_responseCache->setTimeToLive("gdelt", 15 * 60);
+    m_responseCache->setTimeToLive("nominatim", 30 * secondsPerDay);
+    m_responseCache->setTimeToLive("wikimapia", 7 * secondsPerDay);
+
+    m_gdeltLayer->setResponseCache(m_responseCache);
+    m_nominatimPlaceLayer->setResponseCache(m_responseCache);
+    m_wikimapiaPlaceLayer->setResponseCache(m_responseCache);
+
+    // Deployments on disconnected networks provide GeoNames extracts for geocoding
+    QString appDataLocation = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    m_nominatimPlaceLayer->loadGazetteer(QDir(appDataLocation).filePath("gazetteer"));
+
+    connect(m_gdeltLayer, &GdeltEventLayer::eventsAdded, this, &GEOINTMonitor::gdeltEventsAdded);
+    connect(m_liveTimer, &QTimer::timeout, this, &GEOINTMonitor::liveRefresh);
+    connect(m_geoJsonLayer, &SimpleGeoJsonLayer::loadProgress, this, &GEOINTMonitor::geoJsonLoading);
+    connect(m_nominatimPlaceLayer, &NominatimPlaceLayer::batchProgress, this, &GEOINTMonitor::placesGeocoded);
+    connect(m_nominatimPlaceLayer, &NominatimPlaceLayer::suggestionsChanged, this, &GEOINTMonitor::placeSuggestionsReceived);
 }
 
 GEOINTMonitor::~GEOINTMonitor()
@@ -68,7 +95,6 @@ void GEOINTMonitor::setMapView(MapQuickView* mapView)
     m_mapView->setMap(m_map);
     connect(m_mapView, &MapQuickView::exportImageCompleted, this, &GEOINTMonitor::exportMapImageCompleted);
     connect(m_mapView, &MapQuickView::mouseClicked, this, &GEOINTMonitor::mouseClicked);
-    connect(m_mapView, &MapQuickView::identifyGraphicsOverlayCompleted, this, &GEOINTMonitor::identifyGraphicsOverlayCompleted);
     connect(m_mapView, &MapQuickView::navigatingChanged, this, &GEOINTMonitor::navigatingChanged);
     //connect(m_mapView, &MapQuickView::viewpointChanged, this, &GEOINTMonitor::viewpointChanged);
 
@@ -95,6 +121,16 @@ void GEOINTMonitor::setMapView(MapQuickView* mapView)
     // Add the GDELT query layer
     GraphicsOverlay* gdeltOverlay = m_gdeltLayer->overlay();
     m_mapView->graphicsOverlays()->append(gdeltOverlay);
+    GraphicsOverlay* gdeltClusterOverlay = m_gdeltLayer->clusterOverlay();
+    m_mapView->graphicsOverlays()->append(gdeltClusterOverlay);
+
+    // Clicks are resolved against one index, events rank before places and points before areas
+    m_hitIndex->addOverlay(gdeltOverlay, 6);
+    m_hitIndex->addOverlay(gdeltClusterOverlay, 12);
+    m_hitIndex->addOverlay(geoJsonPointsOverlay, 6);
+    m_hitIndex->addOverlay(geoJsonLinesOverlay, 2);
+    m_hitIndex->addOverlay(geoJsonAreasOverlay, 0);
+    m_hitIndex->addOverlay(wikimapiaOverlay, 0);
 
     emit mapViewChanged();
 }
@@ -119,6 +155,47 @@ bool GEOINTMonitor::queryWikimapiaEnabled() const
     return m_queryWikimapiaEnabled;
 }
 
+bool GEOINTMonitor::cacheOnly() const
+{
+    return m_responseCache->isCacheOnly();
+}
+
+void GEOINTMonitor::setCacheOnly(bool cacheOnly)
+{
+    if (cacheOnly == m_responseCache->isCacheOnly())
+    {
+        return;
+    }
+
+    m_responseCache->setCacheOnly(cacheOnly);
+    emit cacheOnlyChanged();
+}
+
+bool GEOINTMonitor::liveMonitoring() const
+{
+    return m_liveTimer->isActive();
+}
+
+int GEOINTMonitor::newEventCount() const
+{
+    return m_newEventCount;
+}
+
+int GEOINTMonitor::geoJsonLoadProgress() const
+{
+    return m_geoJsonLoadProgress;
+}
+
+QString GEOINTMonitor::geocodeProgress() const
+{
+    return m_geocodeProgress;
+}
+
+QVariantList GEOINTMonitor::placeSuggestions() const
+{
+    return m_placeSuggestions;
+}
+
 void GEOINTMonitor::activateHeatmapRendering() const
 {
     m_gdeltLayer->setHeatmapRendering(true);
@@ -129,47 +206,70 @@ void GEOINTMonitor::activateSimpleRendering() const
     m_gdeltLayer->setHeatmapRendering(false);
 }
 
+void GEOINTMonitor::activateClusterRendering() const
+{
+    m_gdeltLayer->setHeatmapRendering(false);
+    m_gdeltLayer->setClusterRendering(true);
+    updateGdeltExtent();
+}
+
 void GEOINTMonitor::addGeoJsonLayerFromClipboard() const
 {
     QClipboard* clipboard = QGuiApplication::clipboard();
-    QString clipboardText = clipboard->text();
+    QString clipboardText = clipboard->text().trimmed();
+
+    // Local files are memory mapped instead of being requested
     QUrl geoJsonUrl(clipboardText);
+    if (QFileInfo(clipboardText).isFile())
+    {
+        m_geoJsonLayer->loadFile(clipboardText);
+        updateGeometryLevels();
+        return;
+    }
+    if (geoJsonUrl.isLocalFile())
+    {
+        m_geoJsonLayer->loadFile(geoJsonUrl.toLocalFile());
+        updateGeometryLevels();
+        return;
+    }
+
     m_geoJsonLayer->query(geoJsonUrl);
+    updateGeometryLevels();
 }
 
 void GEOINTMonitor::clearGeoJson() const
 {
-    if (!removeSelectedGraphics(m_geoJsonLayer->pointsOverlay()))
+    if (!m_geoJsonLayer->removeSelectedGraphics(m_geoJsonLayer->pointsOverlay()))
     {
-        m_geoJsonLayer->pointsOverlay()->graphics()->clear();
+        m_geoJsonLayer->clear(m_geoJsonLayer->pointsOverlay());
     }
-    if (!removeSelectedGraphics(m_geoJsonLayer->linesOverlay()))
+    if (!m_geoJsonLayer->removeSelectedGraphics(m_geoJsonLayer->linesOverlay()))
     {
-        m_geoJsonLayer->linesOverlay()->graphics()->clear();
+        m_geoJsonLayer->clear(m_geoJsonLayer->linesOverlay());
     }
-    if (!removeSelectedGraphics(m_geoJsonLayer->areasOverlay()))
+    if (!m_geoJsonLayer->removeSelectedGraphics(m_geoJsonLayer->areasOverlay()))
     {
-        m_geoJsonLayer->areasOverlay()->graphics()->clear();
+        m_geoJsonLayer->clear(m_geoJsonLayer->areasOverlay());
     }
 }
 
 void GEOINTMonitor::clearGdelt() const
 {
-    if (!removeSelectedGraphics(m_gdeltLayer->overlay()))
+    if (!m_gdeltLayer->removeSelectedGraphics())
     {
-        m_gdeltLayer->overlay()->graphics()->clear();
+        m_gdeltLayer->clear();
     }
 }
 
 void GEOINTMonitor::clearNominatim() const
 {
-    if (!removeSelectedGraphics(m_nominatimPlaceLayer->overlay()))
+    if (!m_nominatimPlaceLayer->removeSelectedGraphics(m_nominatimPlaceLayer->overlay()))
     {
-        m_nominatimPlaceLayer->overlay()->graphics()->clear();
+        m_nominatimPlaceLayer->clear(m_nominatimPlaceLayer->overlay());
     }
-    if (!removeSelectedGraphics(m_nominatimPlaceLayer->pointOverlay()))
+    if (!m_nominatimPlaceLayer->removeSelectedGraphics(m_nominatimPlaceLayer->pointOverlay()))
     {
-        m_nominatimPlaceLayer->pointOverlay()->graphics()->clear();
+        m_nominatimPlaceLayer->clear(m_nominatimPlaceLayer->pointOverlay());
     }
 }
 
@@ -195,19 +295,12 @@ void GEOINTMonitor::exportMapImage() const
     m_mapView->exportImage();
 }
 
-void GEOINTMonitor::identifyGraphicsOverlayCompleted(QUuid taskId, Esri::ArcGISRuntime::IdentifyGraphicsOverlayResult* identifyResult)
+void GEOINTMonitor::showIdentifiedGraphics(GraphicsOverlay* overlay, const QList<Graphic*>& graphics)
 {
-    Q_UNUSED(taskId);
-    if (!identifyResult->error().isEmpty())
-    {
-        return;
-    }   
-
-    if (m_wikimapiaPlaceLayer->overlay() == identifyResult->graphicsOverlay())
+    if (m_wikimapiaPlaceLayer->overlay() == overlay)
     {
         // Wikimapia overlay results
-        QList<Graphic*> identifiedWikimapiaGraphics = identifyResult->graphics();
-        foreach (Graphic* graphic, identifiedWikimapiaGraphics)
+        foreach (Graphic* graphic, graphics)
         {
             graphic->setSelected(true);
             QString wikimapiaUrl = graphic->attributes()->attributeValue("url").toString();
@@ -216,83 +309,73 @@ void GEOINTMonitor::identifyGraphicsOverlayCompleted(QUuid taskId, Esri::ArcGISR
         return;
     }
 
-    if (m_gdeltLayer->overlay() == identifyResult->graphicsOverlay())
+    if (m_gdeltLayer->overlay() == overlay)
     {
-        QRegularExpression titlePattern("title=\"(?<title>[^\"]+)\"");
-        QRegularExpression hrefPattern("href=\"(?<href>[^\"]+)\"");
-        QList<Graphic*> identifiedGraphics = identifyResult->graphics();
-        foreach (Graphic* graphic, identifiedGraphics)
-        {
-            m_mapView->calloutData()->setTitle("GDELT Graphic");
-
-            //TODO: Liftetime is bound to the underlying graphic, could be serious!
-            GdeltCalloutData* calloutData = new GdeltCalloutData(graphic);
+        showGdeltCallouts(graphics);
+        return;
+    }
 
-            AttributeListModel* gdeltAttributesModel = graphic->attributes();
-            QStringList gdeltAttributeNames = gdeltAttributesModel->attributeNames();
-            foreach (const QString& gdeltAttributeName, gdeltAttributeNames)
+    if (m_gdeltLayer->clusterOverlay() == overlay)
+    {
+        QList<Graphic*> gdeltGraphics;
+        foreach (Graphic* clusterGraphic, graphics)
+        {
+            Envelope clusterExtent;
+            if (m_gdeltLayer->clusterExtent(clusterGraphic, clusterExtent))
             {
-                QVariant gdeltAttributeValue = gdeltAttributesModel->attributeValue(gdeltAttributeName);
-                QString gdeltAttributeValueAsString = gdeltAttributeValue.toString();
-                if (0 == gdeltAttributeName.compare("name"))
-                {
-                    m_mapView->calloutData()->setTitle(gdeltAttributeValueAsString);
-                    calloutData->setTitle(gdeltAttributeValueAsString);
-                }
-                else if (0 == gdeltAttributeName.compare("html"))
-                {
-                    QRegularExpressionMatch titleMatch = titlePattern.match(gdeltAttributeValueAsString);
-                    if (titleMatch.hasMatch())
-                    {
-                        QString title = titleMatch.captured("title");
-                        m_mapView->calloutData()->setDetail(title);
-                        calloutData->setDetail(title);
-                    }
-                    else
-                    {
-                        m_mapView->calloutData()->setDetail(gdeltAttributeValueAsString);
-                        calloutData->setDetail(gdeltAttributeValueAsString);
-                    }
-
-                    QRegularExpressionMatch hrefMatch = hrefPattern.match(gdeltAttributeValueAsString);
-                    if (hrefMatch.hasMatch())
-                    {
-                        // Set the news url
-                        QString href = hrefMatch.captured("href");
-                        calloutData->setLink(href);
-                    }
-                }
-                else if (0 == gdeltAttributeName.compare("shareimage"))
-                {
-                    m_mapView->calloutData()->setImageUrl(QUrl(gdeltAttributeValueAsString));
-                }
-                else if (0 == gdeltAttributeName.compare("uid"))
-                {
-                    calloutData->setUniqueId(gdeltAttributeValueAsString);
-                }
+                // Expand the cluster by zooming into its cell
+                m_mapView->setViewpointGeometry(clusterExtent);
+                return;
             }
 
-            // Select the graphic and add the callout data
-            graphic->setSelected(true);
-            m_lastCalloutData.append(QVariant::fromValue(calloutData));
+            // Clusters of one event refer to the event by its unique id
+            gdeltGraphics.append(clusterGraphic);
+        }
 
-            // TODO: Ugly UI do not show
-            //m_mapView->calloutData()->setVisible(true);
+        showGdeltCallouts(gdeltGraphics);
+        return;
+    }
+
+    // Just select the identified graphics
+    overlay->selectGraphics(graphics);
+}
+
+void GEOINTMonitor::showGdeltCallouts(const QList<Graphic*>& graphics)
+{
+    foreach (Graphic* graphic, graphics)
+    {
+        // The graphics only carry the unique id, the callout fields were extracted during ingest
+        QString gdeltUid = graphic->attributes()->attributeValue("uid").toString();
+        GdeltCalloutData* calloutData = m_gdeltLayer->createCalloutData(gdeltUid, this);
+        if (nullptr == calloutData)
+        {
+            continue;
         }
 
-        if (!identifiedGraphics.empty())
+        QString calloutTitle = calloutData->title();
+        m_mapView->calloutData()->setTitle(calloutTitle.isEmpty() ? "GDELT Graphic" : calloutTitle);
+        m_mapView->calloutData()->setDetail(calloutData->detail());
+        if (!calloutData->imageUrl().isEmpty())
         {
-            // Only when there is at least one identified graphics
-            emit calloutDataChanged();
+            m_mapView->calloutData()->setImageUrl(calloutData->imageUrl());
         }
 
-        // Only for the popup listeners
-        emit identifyCompleted();
-        return;
+        // Select the graphic and add the callout data
+        graphic->setSelected(true);
+        m_lastCalloutData.append(QVariant::fromValue(calloutData));
+
+        // TODO: Ugly UI do not show
+        //m_mapView->calloutData()->setVisible(true);
     }
 
-    // Just select the identified graphics
-    identifyResult->graphicsOverlay()->selectGraphics(identifyResult->graphics());
+    if (!graphics.empty())
+    {
+        // Only when there is at least one identified graphics
+        emit calloutDataChanged();
+    }
+
+    // Only for the popup listeners
+    emit identifyCompleted();
 }
 
 void GEOINTMonitor::mouseClicked(QMouseEvent& mouseEvent)
@@ -316,31 +399,37 @@ void GEOINTMonitor::mouseClicked(QMouseEvent& mouseEvent)
     }
     m_mapView->calloutData()->setLocation(mapClickLocation);
 
-    // Identify the graphics
+    // Clear the callout data
+    foreach (const QVariant& calloutData, m_lastCalloutData)
+    {
+        calloutData.value<QObject*>()->deleteLater();
+    }
+    m_lastCalloutData.clear();
+
+    // Identify the graphics synchronously using the hit index
     const double pixelTolerance = 3;
     const int maxResults = 50;
-    bool onlyPopups = false;
-
-    GraphicsOverlay* gdeltOverlay = m_gdeltLayer->overlay();
-    gdeltOverlay->clearSelection();
-    m_mapView->identifyGraphicsOverlay(gdeltOverlay, mouseEvent.x(), mouseEvent.y(), pixelTolerance, onlyPopups, maxResults);
-
-    GraphicsOverlay* geoJsonPointsOverlay = m_geoJsonLayer->pointsOverlay();
-    geoJsonPointsOverlay->clearSelection();
-    m_mapView->identifyGraphicsOverlay(geoJsonPointsOverlay, mouseEvent.x(), mouseEvent.y(), pixelTolerance, onlyPopups, maxResults);
-    GraphicsOverlay* geoJsonLinesOverlay = m_geoJsonLayer->linesOverlay();
-    geoJsonLinesOverlay->clearSelection();
-    m_mapView->identifyGraphicsOverlay(geoJsonLinesOverlay, mouseEvent.x(), mouseEvent.y(), pixelTolerance, onlyPopups, maxResults);
-    GraphicsOverlay* geoJsonAreasOverlay = m_geoJsonLayer->areasOverlay();
-    geoJsonAreasOverlay->clearSelection();
-    m_mapView->identifyGraphicsOverlay(geoJsonAreasOverlay, mouseEvent.x(), mouseEvent.y(), pixelTolerance, onlyPopups, maxResults);
-
-    GraphicsOverlay* wikimapiaOverlay = m_wikimapiaPlaceLayer->overlay();
-    wikimapiaOverlay->clearSelection();
-    m_mapView->identifyGraphicsOverlay(wikimapiaOverlay, mouseEvent.x(), mouseEvent.y(), pixelTolerance, onlyPopups, maxResults);
+    QList<GraphicsOverlay*> identifiableOverlays = m_hitIndex->overlays();
+    foreach (GraphicsOverlay* identifiableOverlay, identifiableOverlays)
+    {
+        identifiableOverlay->clearSelection();
+    }
 
-    // Clear the callout data
-    m_lastCalloutData.clear();
+    QList<GraphicHitIndex::Hit> hits = m_hitIndex->hitTest(m_mapView, m_lastMouseClickLocation, pixelTolerance, maxResults);
+    if (!hits.isEmpty())
+    {
+        // The best ranked overlay handles the click together with all of its hits
+        GraphicsOverlay* hitOverlay = hits.first().overlay;
+        QList<Graphic*> hitGraphics;
+        foreach (const GraphicHitIndex::Hit& hit, hits)
+        {
+            if (hitOverlay == hit.overlay)
+            {
+                hitGraphics.append(hit.graphic);
+            }
+        }
+        showIdentifiedGraphics(hitOverlay, hitGraphics);
+    }
 
     // Query wikimapia
     /*
@@ -356,6 +445,72 @@ void GEOINTMonitor::mouseClicked(QMouseEvent& mouseEvent)
 void GEOINTMonitor::queryGdelt(const QString &queryText, bool useExtent) const
 {
     // Query GDELT
+    setGdeltSpatialFilter(useExtent);
+    m_gdeltLayer->setQueryFilter(queryText);
+    m_gdeltLayer->query();
+}
+
+void GEOINTMonitor::startLiveMonitoring(const QString &queryText, bool useExtent, int intervalSeconds, int timeWindowMinutes)
+{
+    m_liveQueryText = queryText;
+    m_liveUseExtent = useExtent;
+    m_gdeltLayer->setEventTimeWindow(60 * timeWindowMinutes);
+    m_liveTimer->start(1000 * qMax(1, intervalSeconds));
+    liveRefresh();
+    emit liveMonitoringChanged();
+}
+
+void GEOINTMonitor::stopLiveMonitoring()
+{
+    if (!m_liveTimer->isActive())
+    {
+        return;
+    }
+
+    m_liveTimer->stop();
+    m_gdeltLayer->setEventTimeWindow(0);
+    emit liveMonitoringChanged();
+}
+
+void GEOINTMonitor::liveRefresh()
+{
+    // Re-poll the monitored query, only the new events are added
+    setGdeltSpatialFilter(m_liveUseExtent);
+    m_gdeltLayer->setQueryFilter(m_liveQueryText);
+    m_gdeltLayer->refresh();
+}
+
+void GEOINTMonitor::gdeltEventsAdded(int newEventCount)
+{
+    m_newEventCount = newEventCount;
+    emit newEventCountChanged();
+}
+
+void GEOINTMonitor::geoJsonLoading(qint64 bytesRead, qint64 bytesTotal)
+{
+    // Only whole percents are notified
+    int loadProgress = (0 < bytesTotal) ? int(100 * bytesRead / bytesTotal) : 100;
+    if (loadProgress != m_geoJsonLoadProgress)
+    {
+        m_geoJsonLoadProgress = loadProgress;
+        emit geoJsonLoadProgressChanged();
+    }
+}
+
+void GEOINTMonitor::placesGeocoded(int resolvedCount, int placeCount)
+{
+    m_geocodeProgress = QString("%1 of %2 places geocoded").arg(resolvedCount).arg(placeCount);
+    emit geocodeProgressChanged();
+}
+
+void GEOINTMonitor::placeSuggestionsReceived(const QVariantList &suggestions)
+{
+    m_placeSuggestions = suggestions;
+    emit placeSuggestionsChanged();
+}
+
+void GEOINTMonitor::setGdeltSpatialFilter(bool useExtent) const
+{
     if (useExtent)
     {
         Viewpoint boundingViewpoint = m_mapView->currentViewpoint(ViewpointType::BoundingGeometry);
@@ -368,17 +523,39 @@ void GEOINTMonitor::queryGdelt(const QString &queryText, bool useExtent) const
         // Set an empty envelope as no spatial filter
         m_gdeltLayer->setSpatialFilter(Envelope());
     }
-    m_gdeltLayer->setQueryFilter(queryText);
-    m_gdeltLayer->query();
 }
 
 void GEOINTMonitor::queryNominatim(const QString &queryText) const
 {
+    // Lists of places separated by lines or semicolons are geocoded as a batch
+    QStringList placeNames = queryText.split(QRegularExpression("[\\n;]"), QString::SkipEmptyParts);
+    if (1 < placeNames.count())
+    {
+        m_nominatimPlaceLayer->queryBatch(placeNames);
+        return;
+    }
+
     // Query OSM Nominatim
     m_nominatimPlaceLayer->setQueryFilter(queryText);
     m_nominatimPlaceLayer->query();
 }
 
+void GEOINTMonitor::suggestPlaces(const QString &text) const
+{
+    // Suggestions are debounced and only carry the name of the place
+    m_nominatimPlaceLayer->suggest(text);
+}
+
+void GEOINTMonitor::selectPlaceSuggestion(int index) const
+{
+    if (index < 0 || m_placeSuggestions.count() <= index)
+    {
+        return;
+    }
+
+    m_nominatimPlaceLayer->querySuggestion(m_placeSuggestions.at(index).toMap());
+}
+
 void GEOINTMonitor::nextPlace()
 {
     m_placeIndex++;
@@ -449,26 +626,47 @@ void GEOINTMonitor::exportMapImageCompleted(QUuid taskId, QImage image)
 
 void GEOINTMonitor::selectGraphic(const QString &graphicUid) const
 {
-    Graphic* gdeltGraphic = m_gdeltLayer->findGraphic(graphicUid);
-    if (nullptr == gdeltGraphic)
+    GraphicsOverlay* overlay = m_gdeltLayer->overlay();
+    Graphic* graphic = m_gdeltLayer->findGraphic(graphicUid);
+    if (nullptr == graphic)
     {
-        return;
+        // Events are not materialized as graphics while clustering
+        Point eventLocation = m_gdeltLayer->eventLocation(graphicUid);
+        if (!eventLocation.isEmpty())
+        {
+            m_mapView->setViewpointCenter(eventLocation);
+            return;
+        }
+
+        graphic = m_nominatimPlaceLayer->findGraphic(graphicUid);
+        if (nullptr == graphic)
+        {
+            return;
+        }
+
+        overlay = (GeometryType::Point == graphic->geometry().geometryType())
+                ? m_nominatimPlaceLayer->pointOverlay()
+                : m_nominatimPlaceLayer->overlay();
     }
 
     // Select and pan
-    m_gdeltLayer->overlay()->clearSelection();
-    gdeltGraphic->setSelected(true);
+    overlay->clearSelection();
+    graphic->setSelected(true);
 
-    Geometry gdeltGeometry = gdeltGraphic->geometry();
-    switch (gdeltGeometry.geometryType())
+    Geometry geometry = graphic->geometry();
+    switch (geometry.geometryType())
     {
     case GeometryType::Point:
         {
-            Point gdeltLocation = (Point)gdeltGeometry;
-            m_mapView->setViewpointCenter(gdeltLocation);
+            Point location = (Point)geometry;
+            m_mapView->setViewpointCenter(location);
         }
         break;
 
+    case GeometryType::Polygon:
+        m_mapView->setViewpointGeometry(geometry);
+        break;
+
     default:
         return;
     }
@@ -502,6 +700,8 @@ void GEOINTMonitor::navigatingChanged()
     {
         // Stopped navigating
         //qDebug() << "STOPP";
+        updateGdeltExtent();
+        updateGeometryLevels();
 
         const double minScale = 1e5;
         if (m_mapView->mapScale() < minScale)
@@ -523,6 +723,45 @@ void GEOINTMonitor::navigatingChanged()
     }
 }
 
+void GEOINTMonitor::updateGdeltExtent() const
+{
+    if (!m_mapView)
+    {
+        return;
+    }
+
+    // Clusters and the visible events are computed in Web Mercator
+    Polygon visibleArea = m_mapView->visibleArea();
+    if (visibleArea.isEmpty())
+    {
+        return;
+    }
+    Envelope visibleExtent = GeometryEngine::project(visibleArea.extent(), SpatialReference::webMercator()).extent();
+    m_gdeltLayer->updateVisibleExtent(visibleExtent, m_mapView->unitsPerDIP());
+}
+
+void GEOINTMonitor::updateGeometryLevels() const
+{
+    if (!m_mapView)
+    {
+        return;
+    }
+
+    // The generalized geometries and the GeoJSON tiles are in WGS84
+    const double degreesPerMeter = 180.0 / (M_PI * 6378137.0);
+    double unitsPerPixel = m_mapView->unitsPerDIP();
+    double degreesPerPixel = m_mapView->spatialReference().isGeographic() ? unitsPerPixel : unitsPerPixel * degreesPerMeter;
+    m_nominatimPlaceLayer->setResolution(degreesPerPixel);
+
+    Polygon visibleArea = m_mapView->visibleArea();
+    if (visibleArea.isEmpty())
+    {
+        return;
+    }
+    Envelope visibleExtent = GeometryEngine::project(visibleArea.extent(), SpatialReference::wgs84()).extent();
+    m_geoJsonLayer->updateTiles(visibleExtent, degreesPerPixel);
+}
+
 void GEOINTMonitor::viewpointChanged()
 {
     qDebug() << "viewpoint changed";
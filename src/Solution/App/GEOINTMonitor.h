@@ -18,7 +18,9 @@
 
 class GdeltCalloutData;
 class GdeltEventLayer;
+class GraphicHitIndex;
 class NominatimPlaceLayer;
+class ResponseCache;
 class SimpleGeoJsonLayer;
 class WikimapiaPlaceLayer;
 
@@ -27,7 +29,7 @@ namespace Esri
 namespace ArcGISRuntime
 {
 class CalloutData;
-class IdentifyGraphicsOverlayResult;
+class Graphic;
 class GraphicsOverlay;
 class Map;
 class MapQuickView;
@@ -38,6 +40,7 @@ class MapQuickView;
 #include <QObject>
 #include <QMouseEvent>
 #include <QPoint>
+#include <QTimer>
 #include <QUuid>
 
 class GEOINTMonitor : public QObject
@@ -49,6 +52,12 @@ class GEOINTMonitor : public QObject
     Q_PROPERTY(QPoint lastMouseClickLocation READ lastMouseClickLocation NOTIFY mouseClickLocationChanged)
     Q_PROPERTY(QVariantList lastCalloutData READ lastCalloutData NOTIFY calloutDataChanged)
     Q_PROPERTY(bool queryWikimapiaEnabled READ queryWikimapiaEnabled NOTIFY wikimapiaStateChanged)
+    Q_PROPERTY(bool cacheOnly READ cacheOnly WRITE setCacheOnly NOTIFY cacheOnlyChanged)
+    Q_PROPERTY(bool liveMonitoring READ liveMonitoring NOTIFY liveMonitoringChanged)
+    Q_PROPERTY(int newEventCount READ newEventCount NOTIFY newEventCountChanged)
+    Q_PROPERTY(int geoJsonLoadProgress READ geoJsonLoadProgress NOTIFY geoJsonLoadProgressChanged)
+    Q_PROPERTY(QString geocodeProgress READ geocodeProgress NOTIFY geocodeProgressChanged)
+    Q_PROPERTY(QVariantList placeSuggestions READ placeSuggestions NOTIFY placeSuggestionsChanged)
 
 public:
     explicit GEOINTMonitor(QObject* parent = nullptr);
@@ -56,6 +65,7 @@ public:
 
     Q_INVOKABLE void activateHeatmapRendering() const;
     Q_INVOKABLE void activateSimpleRendering() const;
+    Q_INVOKABLE void activateClusterRendering() const;
     Q_INVOKABLE void addGeoJsonLayerFromClipboard() const;
     Q_INVOKABLE void clearGeoJson() const;
     Q_INVOKABLE void clearGdelt() const;
@@ -65,8 +75,12 @@ public:
     Q_INVOKABLE void queryGdelt(const QString& queryText, bool useExtent) const;
     Q_INVOKABLE void queryNominatim(const QString& queryText) const;
     Q_INVOKABLE void nextPlace();
+    Q_INVOKABLE void suggestPlaces(const QString& text) const;
+    Q_INVOKABLE void selectPlaceSuggestion(int index) const;
     Q_INVOKABLE void queryWikimapia();
     Q_INVOKABLE void selectGraphic(const QString& graphicUid) const;
+    Q_INVOKABLE void startLiveMonitoring(const QString& queryText, bool useExtent, int intervalSeconds = 60, int timeWindowMinutes = 60);
+    Q_INVOKABLE void stopLiveMonitoring();
 
 signals:
     void identifyCompleted();
@@ -75,10 +89,20 @@ signals:
     void mouseClickLocationChanged();
     void calloutDataChanged();
     void wikimapiaStateChanged();
+    void cacheOnlyChanged();
+    void liveMonitoringChanged();
+    void newEventCountChanged();
+    void geoJsonLoadProgressChanged();
+    void geocodeProgressChanged();
+    void placeSuggestionsChanged();
 
 private slots:
     void exportMapImageCompleted(QUuid taskId, QImage image);
-    void identifyGraphicsOverlayCompleted(QUuid taskId, Esri::ArcGISRuntime::IdentifyGraphicsOverlayResult* identifyResult);
+    void gdeltEventsAdded(int newEventCount);
+    void geoJsonLoading(qint64 bytesRead, qint64 bytesTotal);
+    void placesGeocoded(int resolvedCount, int placeCount);
+    void placeSuggestionsReceived(const QVariantList& suggestions);
+    void liveRefresh();
     void mouseClicked(QMouseEvent& mouseEvent);
     void navigatingChanged();
     void viewpointChanged();
@@ -93,22 +117,51 @@ private:
 
     bool queryWikimapiaEnabled() const;
 
+    bool cacheOnly() const;
+    void setCacheOnly(bool cacheOnly);
+
+    bool liveMonitoring() const;
+    int newEventCount() const;
+    int geoJsonLoadProgress() const;
+    QString geocodeProgress() const;
+    QVariantList placeSuggestions() const;
+
+    void setGdeltSpatialFilter(bool useExtent) const;
+
     bool removeSelectedGraphics(Esri::ArcGISRuntime::GraphicsOverlay* overlay) const;
 
+    void showIdentifiedGraphics(Esri::ArcGISRuntime::GraphicsOverlay* overlay, const QList<Esri::ArcGISRuntime::Graphic*>& graphics);
+
+    void showGdeltCallouts(const QList<Esri::ArcGISRuntime::Graphic*>& graphics);
+
+    void updateGdeltExtent() const;
+
+    void updateGeometryLevels() const;
+
     Esri::ArcGISRuntime::Map* m_map = nullptr;
     Esri::ArcGISRuntime::MapQuickView* m_mapView = nullptr;
     QString m_lastMapImageFilePath;
     QPoint m_lastMouseClickLocation;
 
     QVariantList m_lastCalloutData;
+    ResponseCache* m_responseCache = nullptr;
     GdeltEventLayer* m_gdeltLayer = nullptr;
     NominatimPlaceLayer* m_nominatimPlaceLayer = nullptr;
     SimpleGeoJsonLayer* m_geoJsonLayer = nullptr;
     WikimapiaPlaceLayer* m_wikimapiaPlaceLayer = nullptr;
+    GraphicHitIndex* m_hitIndex = nullptr;
     bool m_queryWikimapiaEnabled = false;
     Esri::ArcGISRuntime::Envelope m_lastQueriedBoundingBox;
 
     int m_placeIndex = -1;
+    QVariantList m_placeSuggestions;
+
+    QTimer* m_liveTimer = nullptr;
+    QString m_liveQueryText;
+    bool m_liveUseExtent = false;
+    int m_newEventCount = 0;
+    int m_geoJsonLoadProgress = 100;
+    QString m_geocodeProgress;
 
     bool m_navigating = false;
 };
@@ -1,19 +1,48 @@
 HEADERS += \
     $$PWD/GdeltCalloutData.h \
     $$PWD/GdeltEventLayer.h \
+    $$PWD/GdeltEventStore.h \
+    $$PWD/GazetteerIndex.h \
     $$PWD/AppInfo.h \
+    $$PWD/EventClusterIndex.h \
+    $$PWD/FeatureParsePipeline.h \
+    $$PWD/GeocodeCache.h \
+    $$PWD/GeoJsonBinaryCache.h \
+    $$PWD/GeoJsonStreamReader.h \
+    $$PWD/GeoJsonTileIndex.h \
+    $$PWD/GeometryPyramid.h \
     $$PWD/GEOINTMonitor.h \
+    $$PWD/GraphicHitIndex.h \
     $$PWD/GraphicsFactory.h \
     $$PWD/NominatimPlaceLayer.h \
+    $$PWD/OverlayVirtualizer.h \
+    $$PWD/ParsedFeature.h \
+    $$PWD/RequestScheduler.h \
+    $$PWD/ResponseCache.h \
     $$PWD/SimpleGeoJsonLayer.h \
+    $$PWD/StreamDecompressor.h \
     $$PWD/WikimapiaPlaceLayer.h
 
 SOURCES += \
+    $$PWD/EventClusterIndex.cpp \
+    $$PWD/FeatureParsePipeline.cpp \
     $$PWD/GdeltCalloutData.cpp \
     $$PWD/GdeltEventLayer.cpp \
+    $$PWD/GdeltEventStore.cpp \
+    $$PWD/GazetteerIndex.cpp \
+    $$PWD/GeocodeCache.cpp \
+    $$PWD/GeoJsonBinaryCache.cpp \
+    $$PWD/GeoJsonStreamReader.cpp \
+    $$PWD/GeoJsonTileIndex.cpp \
+    $$PWD/GeometryPyramid.cpp \
+    $$PWD/GraphicHitIndex.cpp \
     $$PWD/GraphicsFactory.cpp \
     $$PWD/NominatimPlaceLayer.cpp \
+    $$PWD/OverlayVirtualizer.cpp \
+    $$PWD/RequestScheduler.cpp \
+    $$PWD/ResponseCache.cpp \
     $$PWD/SimpleGeoJsonLayer.cpp \
+    $$PWD/StreamDecompressor.cpp \
     $$PWD/WikimapiaPlaceLayer.cpp \
     $$PWD/main.cpp \
     $$PWD/GEOINTMonitor.cpp
@@ -22,6 +51,35 @@ RESOURCES += \
     $$PWD/qml/qml.qrc \
     $$PWD/Resources/Resources.qrc
 
+# Streaming decompression links a system zlib, zstd is enabled by CONFIG+=zstd
+win32 {
+    # ZLIB_DIR is a zlib installation holding include/zlib.h and lib/zlib.lib
+    isEmpty(ZLIB_DIR): ZLIB_DIR = $$(ZLIB_DIR)
+    !exists($$ZLIB_DIR/include/zlib.h) {
+        error("zlib was not found, set ZLIB_DIR to a zlib installation.")
+    }
+    INCLUDEPATH += $$ZLIB_DIR/include
+    LIBS += -L$$ZLIB_DIR/lib -lzlib
+} else:macx|ios|android {
+    # Part of the platform SDK
+    LIBS += -lz
+} else {
+    CONFIG += link_pkgconfig
+    packagesExist(zlib) {
+        PKGCONFIG += zlib
+    } else:exists(/usr/include/zlib.h) {
+        LIBS += -lz
+    } else {
+        error("zlib was not found, install the zlib development package.")
+    }
+}
+
+zstd {
+    DEFINES += GEOINT_ZSTD
+    unix: LIBS += -lzstd
+    win32: LIBS += zstd.lib
+}
+
 #-------------------------------------------------------------------------------
 
 win32 {
@@ -0,0 +1,743 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "GazetteerIndex.h"
+
+#include "GeocodeCache.h"
+
+#include "Point.h"
+#include "SpatialReference.h"
+
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace
+{
+const char FormatMagic[] = "GZIX";
+const quint32 FormatVersion = 1;
+
+// Magic, version, place, name and trigram counts followed by the five section positions
+const qint64 HeaderSize = 64;
+
+// Location, population, GeoNames id and the offsets of name, feature class, feature code and country code
+const qint64 PlaceRecordSize = 40;
+
+// Offset of the normalized name and the place id
+const qint64 NameRecordSize = 8;
+
+// Trigram, offset and length of its posting list
+const qint64 TrigramRecordSize = 16;
+
+// Columns of the GeoNames main table
+enum GeoNamesColumn
+{
+    GeoNameIdColumn = 0,
+    NameColumn = 1,
+    AsciiNameColumn = 2,
+    AlternateNamesColumn = 3,
+    LatitudeColumn = 4,
+    LongitudeColumn = 5,
+    FeatureClassColumn = 6,
+    FeatureCodeColumn = 7,
+    CountryCodeColumn = 8,
+    PopulationColumn = 14,
+    ColumnCount = 19
+};
+
+// Names being longer are no place names but descriptions or links
+const int MaximumNameLength = 100;
+
+// Trigrams of very common posting lists hardly narrow the candidates down
+const quint32 MaximumPostingCount = 100000;
+
+// Misspelled names need this share of trigrams in common with the query
+const double MinimumSimilarity = 0.6;
+
+// Names starting with a prefix being ranked by the population of their places
+const int MaximumCompletionCandidates = 1000;
+
+// Place id of name records pointing beyond the places section
+const quint32 InvalidPlaceId = std::numeric_limits<quint32>::max();
+
+void appendUInt32(QByteArray& buffer, quint32 value)
+{
+    value = qToLittleEndian(value);
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendUInt64(QByteArray& buffer, quint64 value)
+{
+    value = qToLittleEndian(value);
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendDouble(QByteArray& buffer, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendUInt64(buffer, bits);
+}
+
+void alignSection(QByteArray& buffer)
+{
+    while (0 != buffer.size() % 8)
+    {
+        buffer.append('\0');
+    }
+}
+
+struct PlaceRecord
+{
+    double x = 0;
+    double y = 0;
+    quint32 population = 0;
+    quint32 geoNameId = 0;
+    quint32 nameOffset = 0;
+    quint32 featureClassOffset = 0;
+    quint32 featureCodeOffset = 0;
+    quint32 countryCodeOffset = 0;
+};
+
+struct NameRecord
+{
+    quint32 nameOffset = 0;
+    quint32 placeId = 0;
+};
+
+// Null terminated UTF-8 strings, every distinct string is stored once
+class StringPool
+{
+public:
+    quint32 intern(const QByteArray& value)
+    {
+        auto offsetIterator = m_offsets.constFind(value);
+        if (offsetIterator != m_offsets.constEnd())
+        {
+            return offsetIterator.value();
+        }
+
+        quint32 offset = quint32(m_data.size());
+        m_data.append(value);
+        m_data.append('\0');
+        m_offsets.insert(value, offset);
+        return offset;
+    }
+
+    const char* string(quint32 offset) const
+    {
+        return m_data.constData() + offset;
+    }
+
+    const QByteArray& data() const
+    {
+        return m_data;
+    }
+
+private:
+    QByteArray m_data;
+    QHash<QByteArray, quint32> m_offsets;
+};
+}
+
+GazetteerIndex::GazetteerIndex()
+{
+}
+
+bool GazetteerIndex::open(const QString &indexFilePath)
+{
+    *this = GazetteerIndex();
+    QSharedPointer<QFile> indexFile(new QFile(indexFilePath));
+    if (!indexFile->open(QIODevice::ReadOnly) || indexFile->size() < HeaderSize)
+    {
+        return false;
+    }
+
+    const uchar* data = indexFile->map(0, indexFile->size());
+    if (nullptr == data)
+    {
+        qDebug() << "Gazetteer index cannot be mapped!" << indexFile->errorString();
+        return false;
+    }
+    m_data = data;
+    m_size = indexFile->size();
+
+    if (0 != std::memcmp(m_data, FormatMagic, 4) || FormatVersion != readUInt32(4))
+    {
+        qDebug() << "Gazetteer index has an unknown format!";
+        *this = GazetteerIndex();
+        return false;
+    }
+
+    quint32 placeCount = readUInt32(8);
+    quint32 nameCount = readUInt32(12);
+    quint32 trigramCount = readUInt32(16);
+    qint64 placesPosition = qint64(readUInt64(24));
+    qint64 namesPosition = qint64(readUInt64(32));
+    qint64 trigramsPosition = qint64(readUInt64(40));
+    qint64 postingsPosition = qint64(readUInt64(48));
+    qint64 stringsPosition = qint64(readUInt64(56));
+
+    // Truncated or corrupted files are rejected before anything is read from the sections,
+    // the strings section is the last one and ends with a terminator
+    bool validLayout = HeaderSize <= placesPosition
+            && placesPosition + PlaceRecordSize * qint64(placeCount) <= namesPosition
+            && namesPosition + NameRecordSize * qint64(nameCount) <= trigramsPosition
+            && trigramsPosition + TrigramRecordSize * qint64(trigramCount) <= postingsPosition
+            && postingsPosition <= stringsPosition
+            && stringsPosition < m_size
+            && '\0' == m_data[m_size - 1];
+    if (!validLayout)
+    {
+        qDebug() << "Gazetteer index is corrupted!";
+        *this = GazetteerIndex();
+        return false;
+    }
+
+    m_file = indexFile;
+    m_placeCount = int(placeCount);
+    m_nameCount = int(nameCount);
+    m_trigramCount = int(trigramCount);
+    m_placesPosition = placesPosition;
+    m_namesPosition = namesPosition;
+    m_trigramsPosition = trigramsPosition;
+    m_postingsPosition = postingsPosition;
+    m_stringsPosition = stringsPosition;
+    return true;
+}
+
+bool GazetteerIndex::isValid() const
+{
+    return nullptr != m_data && m_file;
+}
+
+int GazetteerIndex::placeCount() const
+{
+    return m_placeCount;
+}
+
+ParsedFeatureList GazetteerIndex::lookup(const QString &normalizedQuery, int maximumCount) const
+{
+    ParsedFeatureList features;
+    if (!isValid() || normalizedQuery.isEmpty())
+    {
+        return features;
+    }
+
+    // Places having the name, the most populated ones come first
+    QByteArray queryName = normalizedQuery.toUtf8();
+    QSet<quint32> placeIds;
+    for (int nameIndex = lowerBound(queryName); nameIndex < m_nameCount && features.count() < maximumCount; nameIndex++)
+    {
+        if (0 != std::strcmp(name(nameIndex), queryName.constData()))
+        {
+            break;
+        }
+
+        quint32 placeId = namePlaceId(nameIndex);
+        if (InvalidPlaceId != placeId && !placeIds.contains(placeId))
+        {
+            placeIds.insert(placeId);
+            features.append(place(placeId));
+        }
+    }
+    return features;
+}
+
+QList<quint32> GazetteerIndex::complete(const QString &normalizedPrefix, int maximumCount) const
+{
+    QList<quint32> placeIds;
+    if (!isValid() || normalizedPrefix.isEmpty())
+    {
+        return placeIds;
+    }
+
+    // The first names starting with the prefix, short prefixes do not scan the whole index
+    QByteArray prefix = normalizedPrefix.toUtf8();
+    QList<QPair<quint32, quint32>> candidates;
+    QSet<quint32> candidatePlaceIds;
+    for (int nameIndex = lowerBound(prefix); nameIndex < m_nameCount && candidates.count() < MaximumCompletionCandidates; nameIndex++)
+    {
+        if (0 != std::strncmp(name(nameIndex), prefix.constData(), size_t(prefix.size())))
+        {
+            break;
+        }
+
+        quint32 placeId = namePlaceId(nameIndex);
+        if (InvalidPlaceId != placeId && !candidatePlaceIds.contains(placeId))
+        {
+            candidatePlaceIds.insert(placeId);
+            candidates.append(qMakePair(placePopulation(placeId), placeId));
+        }
+    }
+
+    // The most populated places first
+    std::stable_sort(candidates.begin(), candidates.end(), [](const QPair<quint32, quint32>& left, const QPair<quint32, quint32>& right)
+    {
+        return right.first < left.first;
+    });
+    for (int candidateIndex = 0; candidateIndex < candidates.count() && candidateIndex < maximumCount; candidateIndex++)
+    {
+        placeIds.append(candidates.at(candidateIndex).second);
+    }
+    return placeIds;
+}
+
+QList<quint32> GazetteerIndex::similar(const QString &normalizedQuery, int maximumCount) const
+{
+    QList<quint32> placeIds;
+    if (!isValid() || normalizedQuery.isEmpty())
+    {
+        return placeIds;
+    }
+
+    // Misspelled names are matched by their trigrams, the most similar names first
+    QSet<quint32> similarPlaceIds;
+    QList<int> nameIndexes = similarNames(normalizedQuery, maximumCount);
+    foreach (int nameIndex, nameIndexes)
+    {
+        quint32 placeId = namePlaceId(nameIndex);
+        if (InvalidPlaceId != placeId && !similarPlaceIds.contains(placeId))
+        {
+            similarPlaceIds.insert(placeId);
+            placeIds.append(placeId);
+        }
+    }
+    return placeIds;
+}
+
+bool GazetteerIndex::build(const QStringList &extractFilePaths, const QString &indexFilePath)
+{
+    StringPool strings;
+    QVector<PlaceRecord> places;
+    QVector<NameRecord> names;
+    foreach (const QString& extractFilePath, extractFilePaths)
+    {
+        QFile extractFile(extractFilePath);
+        if (!extractFile.open(QIODevice::ReadOnly))
+        {
+            qDebug() << extractFile.errorString();
+            continue;
+        }
+
+        while (!extractFile.atEnd())
+        {
+            QByteArray line = extractFile.readLine();
+            if (line.startsWith('#'))
+            {
+                continue;
+            }
+
+            QList<QByteArray> columns = line.split('\t');
+            if (columns.count() < ColumnCount)
+            {
+                continue;
+            }
+
+            PlaceRecord place;
+            bool validLocation = false;
+            place.y = columns.at(LatitudeColumn).toDouble(&validLocation);
+            if (validLocation)
+            {
+                place.x = columns.at(LongitudeColumn).toDouble(&validLocation);
+            }
+            if (!validLocation)
+            {
+                continue;
+            }
+            place.population = quint32(qBound(qint64(0), columns.at(PopulationColumn).toLongLong(), qint64(std::numeric_limits<quint32>::max())));
+            place.geoNameId = columns.at(GeoNameIdColumn).toUInt();
+            place.nameOffset = strings.intern(columns.at(NameColumn));
+            place.featureClassOffset = strings.intern(columns.at(FeatureClassColumn));
+            place.featureCodeOffset = strings.intern(columns.at(FeatureCodeColumn));
+            place.countryCodeOffset = strings.intern(columns.at(CountryCodeColumn));
+
+            // Every name of the place is normalized once
+            QList<QByteArray> placeNames = columns.at(AlternateNamesColumn).split(',');
+            placeNames.prepend(columns.at(AsciiNameColumn));
+            placeNames.prepend(columns.at(NameColumn));
+            QSet<QByteArray> normalizedNames;
+            foreach (const QByteArray& placeName, placeNames)
+            {
+                if (placeName.isEmpty() || MaximumNameLength < placeName.length())
+                {
+                    continue;
+                }
+                QByteArray normalizedName = GeocodeCache::normalizedQuery(QString::fromUtf8(placeName)).toUtf8();
+                if (!normalizedName.isEmpty() && !normalizedNames.contains(normalizedName))
+                {
+                    normalizedNames.insert(normalizedName);
+                    NameRecord nameRecord;
+                    nameRecord.nameOffset = strings.intern(normalizedName);
+                    nameRecord.placeId = quint32(places.count());
+                    names.append(nameRecord);
+                }
+            }
+            places.append(place);
+        }
+    }
+
+    if (places.isEmpty())
+    {
+        qDebug() << "Gazetteer extracts hold no places!" << extractFilePaths;
+        return false;
+    }
+
+    // Names are sorted bytewise, equal names by the population of their places
+    std::sort(names.begin(), names.end(), [&strings, &places](const NameRecord& left, const NameRecord& right)
+    {
+        int nameOrder = std::strcmp(strings.string(left.nameOffset), strings.string(right.nameOffset));
+        if (0 != nameOrder)
+        {
+            return nameOrder < 0;
+        }
+        quint32 leftPopulation = places.at(int(left.placeId)).population;
+        quint32 rightPopulation = places.at(int(right.placeId)).population;
+        if (leftPopulation != rightPopulation)
+        {
+            return rightPopulation < leftPopulation;
+        }
+        return left.placeId < right.placeId;
+    });
+
+    // Posting lists of the sorted name indexes by trigram
+    QHash<quint64, QVector<quint32>> postingsByTrigram;
+    for (int nameIndex = 0; nameIndex < names.count(); nameIndex++)
+    {
+        QVector<quint64> nameTrigrams = trigrams(QString::fromUtf8(strings.string(names.at(nameIndex).nameOffset)));
+        foreach (quint64 nameTrigram, nameTrigrams)
+        {
+            postingsByTrigram[nameTrigram].append(quint32(nameIndex));
+        }
+    }
+    QList<quint64> sortedTrigrams = postingsByTrigram.keys();
+    std::sort(sortedTrigrams.begin(), sortedTrigrams.end());
+
+    QByteArray buffer;
+    buffer.append(FormatMagic, 4);
+    appendUInt32(buffer, FormatVersion);
+    appendUInt32(buffer, quint32(places.count()));
+    appendUInt32(buffer, quint32(names.count()));
+    appendUInt32(buffer, quint32(sortedTrigrams.count()));
+    appendUInt32(buffer, 0);
+    int positionsOffset = buffer.size();
+    for (int sectionIndex = 0; sectionIndex < 5; sectionIndex++)
+    {
+        appendUInt64(buffer, 0);
+    }
+
+    QVector<quint64> sectionPositions;
+    sectionPositions.append(quint64(buffer.size()));
+    foreach (const PlaceRecord& place, places)
+    {
+        appendDouble(buffer, place.x);
+        appendDouble(buffer, place.y);
+        appendUInt32(buffer, place.population);
+        appendUInt32(buffer, place.geoNameId);
+        appendUInt32(buffer, place.nameOffset);
+        appendUInt32(buffer, place.featureClassOffset);
+        appendUInt32(buffer, place.featureCodeOffset);
+        appendUInt32(buffer, place.countryCodeOffset);
+    }
+
+    sectionPositions.append(quint64(buffer.size()));
+    foreach (const NameRecord& nameRecord, names)
+    {
+        appendUInt32(buffer, nameRecord.nameOffset);
+        appendUInt32(buffer, nameRecord.placeId);
+    }
+
+    sectionPositions.append(quint64(buffer.size()));
+    quint32 postingOffset = 0;
+    foreach (quint64 sortedTrigram, sortedTrigrams)
+    {
+        quint32 postingCount = quint32(postingsByTrigram.value(sortedTrigram).count());
+        appendUInt64(buffer, sortedTrigram);
+        appendUInt32(buffer, postingOffset);
+        appendUInt32(buffer, postingCount);
+        postingOffset += postingCount;
+    }
+
+    sectionPositions.append(quint64(buffer.size()));
+    foreach (quint64 sortedTrigram, sortedTrigrams)
+    {
+        const QVector<quint32>& postings = postingsByTrigram[sortedTrigram];
+        foreach (quint32 posting, postings)
+        {
+            appendUInt32(buffer, posting);
+        }
+    }
+    alignSection(buffer);
+
+    sectionPositions.append(quint64(buffer.size()));
+    buffer.append(strings.data());
+    buffer.append('\0');
+
+    for (int sectionIndex = 0; sectionIndex < sectionPositions.count(); sectionIndex++)
+    {
+        quint64 sectionPosition = qToLittleEndian(sectionPositions.at(sectionIndex));
+        std::memcpy(buffer.data() + positionsOffset + 8 * sectionIndex, &sectionPosition, sizeof(sectionPosition));
+    }
+
+    QSaveFile indexFile(indexFilePath);
+    if (!indexFile.open(QIODevice::WriteOnly) || buffer.size() != indexFile.write(buffer) || !indexFile.commit())
+    {
+        qDebug() << "Gazetteer index cannot be written!" << indexFile.errorString();
+        return false;
+    }
+
+    qDebug() << places.count() << "places indexed by" << names.count() << "names in" << indexFilePath;
+    return true;
+}
+
+quint32 GazetteerIndex::readUInt32(qint64 position) const
+{
+    return qFromLittleEndian<quint32>(m_data + position);
+}
+
+quint64 GazetteerIndex::readUInt64(qint64 position) const
+{
+    return qFromLittleEndian<quint64>(m_data + position);
+}
+
+double GazetteerIndex::readDouble(qint64 position) const
+{
+    quint64 bits = readUInt64(position);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+const char* GazetteerIndex::string(quint32 offset) const
+{
+    // Offsets beyond the strings section read the final terminator
+    qint64 position = qMin(m_stringsPosition + qint64(offset), m_size - 1);
+    return reinterpret_cast<const char*>(m_data + position);
+}
+
+const char* GazetteerIndex::name(int nameIndex) const
+{
+    return string(readUInt32(m_namesPosition + NameRecordSize * nameIndex));
+}
+
+quint32 GazetteerIndex::namePlaceId(int nameIndex) const
+{
+    quint32 placeId = readUInt32(m_namesPosition + NameRecordSize * nameIndex + 4);
+    return placeId < quint32(m_placeCount) ? placeId : InvalidPlaceId;
+}
+
+quint32 GazetteerIndex::placePopulation(quint32 placeId) const
+{
+    if (quint32(m_placeCount) <= placeId)
+    {
+        return 0;
+    }
+    return readUInt32(m_placesPosition + PlaceRecordSize * placeId + 16);
+}
+
+int GazetteerIndex::lowerBound(const QByteArray &normalizedName) const
+{
+    int first = 0;
+    int count = m_nameCount;
+    while (0 < count)
+    {
+        int step = count / 2;
+        int middle = first + step;
+        if (std::strcmp(name(middle), normalizedName.constData()) < 0)
+        {
+            first = middle + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+    return first;
+}
+
+QList<int> GazetteerIndex::similarNames(const QString &normalizedQuery, int maximumCount) const
+{
+    QList<int> nameIndexes;
+    QVector<quint64> queryTrigrams = trigrams(normalizedQuery);
+    if (queryTrigrams.isEmpty())
+    {
+        return nameIndexes;
+    }
+
+    // Posting lists of the query trigrams as offset and length
+    QList<QPair<quint32, quint32>> postingLists;
+    foreach (quint64 queryTrigram, queryTrigrams)
+    {
+        int first = 0;
+        int count = m_trigramCount;
+        while (0 < count)
+        {
+            int step = count / 2;
+            int middle = first + step;
+            if (readUInt64(m_trigramsPosition + TrigramRecordSize * middle) < queryTrigram)
+            {
+                first = middle + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
+        }
+        qint64 trigramPosition = m_trigramsPosition + TrigramRecordSize * first;
+        if (m_trigramCount <= first || queryTrigram != readUInt64(trigramPosition))
+        {
+            continue;
+        }
+
+        quint32 postingOffset = readUInt32(trigramPosition + 8);
+        quint32 postingCount = readUInt32(trigramPosition + 12);
+        qint64 postingsEnd = m_postingsPosition + 4 * (qint64(postingOffset) + postingCount);
+        if (MaximumPostingCount < postingCount || m_stringsPosition < postingsEnd)
+        {
+            continue;
+        }
+        postingLists.append(qMakePair(postingCount, postingOffset));
+    }
+
+    // A similar name shares one of the rarest trigrams with the query, only their lists add candidates
+    // and the common lists only count the trigrams of those candidates
+    int minimumSharedCount = int(std::ceil(MinimumSimilarity * queryTrigrams.count()));
+    int candidateListCount = postingLists.count() - minimumSharedCount + 1;
+    if (candidateListCount <= 0)
+    {
+        return nameIndexes;
+    }
+    std::sort(postingLists.begin(), postingLists.end());
+
+    // Trigrams shared with the query by name index
+    QHash<quint32, int> sharedCounts;
+    for (int listIndex = 0; listIndex < postingLists.count(); listIndex++)
+    {
+        quint32 postingCount = postingLists.at(listIndex).first;
+        quint32 postingOffset = postingLists.at(listIndex).second;
+        for (quint32 postingIndex = 0; postingIndex < postingCount; postingIndex++)
+        {
+            quint32 nameIndex = readUInt32(m_postingsPosition + 4 * (qint64(postingOffset) + postingIndex));
+            if (listIndex < candidateListCount)
+            {
+                sharedCounts[nameIndex]++;
+                continue;
+            }
+
+            auto sharedIterator = sharedCounts.find(nameIndex);
+            if (sharedIterator != sharedCounts.end())
+            {
+                sharedIterator.value()++;
+            }
+        }
+    }
+
+    // Names similar enough by the Jaccard index of their trigrams
+    QList<QPair<double, int>> similarNameIndexes;
+    for (auto sharedIterator = sharedCounts.constBegin(); sharedIterator != sharedCounts.constEnd(); ++sharedIterator)
+    {
+        int sharedCount = sharedIterator.value();
+        if (sharedCount < minimumSharedCount || quint32(m_nameCount) <= sharedIterator.key())
+        {
+            continue;
+        }
+
+        int nameIndex = int(sharedIterator.key());
+        int nameTrigramCount = trigrams(QString::fromUtf8(name(nameIndex))).count();
+        double similarity = double(sharedCount) / (queryTrigrams.count() + nameTrigramCount - sharedCount);
+        if (MinimumSimilarity <= similarity)
+        {
+            similarNameIndexes.append(qMakePair(similarity, nameIndex));
+        }
+    }
+
+    std::sort(similarNameIndexes.begin(), similarNameIndexes.end(), [this](const QPair<double, int>& left, const QPair<double, int>& right)
+    {
+        if (left.first != right.first)
+        {
+            return right.first < left.first;
+        }
+        return placePopulation(namePlaceId(right.second)) < placePopulation(namePlaceId(left.second));
+    });
+
+    for (int similarIndex = 0; similarIndex < similarNameIndexes.count() && similarIndex < maximumCount; similarIndex++)
+    {
+        nameIndexes.append(similarNameIndexes.at(similarIndex).second);
+    }
+    return nameIndexes;
+}
+
+ParsedFeature GazetteerIndex::place(quint32 placeId) const
+{
+    ParsedFeature feature;
+    if (!isValid() || m_placeCount <= int(placeId))
+    {
+        return feature;
+    }
+
+    // Places carry the properties of Nominatim results
+    qint64 placePosition = m_placesPosition + PlaceRecordSize * placeId;
+    quint32 population = readUInt32(placePosition + 16);
+    QString placeName = QString::fromUtf8(string(readUInt32(placePosition + 24)));
+    QString countryCode = QString::fromUtf8(string(readUInt32(placePosition + 36)));
+
+    feature.geometry = Point(readDouble(placePosition), readDouble(placePosition + 8), SpatialReference::wgs84());
+    feature.attributes.insert("place_id", readUInt32(placePosition + 20));
+    feature.attributes.insert("display_name", countryCode.isEmpty() ? placeName : placeName + ", " + countryCode);
+    feature.attributes.insert("name", placeName);
+    feature.attributes.insert("category", QString::fromUtf8(string(readUInt32(placePosition + 28))));
+    feature.attributes.insert("type", QString::fromUtf8(string(readUInt32(placePosition + 32))));
+    feature.attributes.insert("country_code", countryCode.toLower());
+    feature.attributes.insert("population", population);
+    feature.attributes.insert("importance", std::log10(1.0 + population) / 10.0);
+    feature.attributes.insert("source", "gazetteer");
+    return feature;
+}
+
+QVector<quint64> GazetteerIndex::trigrams(const QString &normalizedName)
+{
+    // Padded like the word boundaries, so that short names have trigrams too
+    QString paddedName = "  " + normalizedName + " ";
+    QVector<quint64> nameTrigrams;
+    nameTrigrams.reserve(paddedName.length());
+    for (int charIndex = 0; charIndex + 3 <= paddedName.length(); charIndex++)
+    {
+        nameTrigrams.append((quint64(paddedName.at(charIndex).unicode()) << 32)
+                            | (quint64(paddedName.at(charIndex + 1).unicode()) << 16)
+                            | quint64(paddedName.at(charIndex + 2).unicode()));
+    }
+    std::sort(nameTrigrams.begin(), nameTrigrams.end());
+    nameTrigrams.erase(std::unique(nameTrigrams.begin(), nameTrigrams.end()), nameTrigrams.end());
+    return nameTrigrams;
+}
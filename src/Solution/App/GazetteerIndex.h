@@ -0,0 +1,91 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef GAZETTEERINDEX_H
+#define GAZETTEERINDEX_H
+
+#include "ParsedFeature.h"
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+class QFile;
+
+// Offline gazetteer answering place queries from a memory mapped index file.
+// The index is built from GeoNames extracts like cities500.txt or a country file.
+// Every name and alternate name of a place is normalized like the geocode queries and
+// sorted for exact and prefix searches, the trigrams of the names have posting lists
+// for finding misspelled names. Lookups only answer exact names, misspelled names are
+// found separately because that takes much longer. The index can be read from any thread.
+// Place ids and name indexes read from the index are checked against the section sizes.
+class GazetteerIndex
+{
+public:
+    GazetteerIndex();
+
+    bool open(const QString& indexFilePath);
+
+    bool isValid() const;
+
+    int placeCount() const;
+
+    ParsedFeatureList lookup(const QString& normalizedQuery, int maximumCount) const;
+
+    QList<quint32> complete(const QString& normalizedPrefix, int maximumCount) const;
+
+    QList<quint32> similar(const QString& normalizedQuery, int maximumCount) const;
+
+    ParsedFeature place(quint32 placeId) const;
+
+    static bool build(const QStringList& extractFilePaths, const QString& indexFilePath);
+
+private:
+    quint32 readUInt32(qint64 position) const;
+    quint64 readUInt64(qint64 position) const;
+    double readDouble(qint64 position) const;
+    const char* string(quint32 offset) const;
+
+    const char* name(int nameIndex) const;
+    quint32 namePlaceId(int nameIndex) const;
+    quint32 placePopulation(quint32 placeId) const;
+    int lowerBound(const QByteArray& normalizedName) const;
+
+    QList<int> similarNames(const QString& normalizedQuery, int maximumCount) const;
+
+    static QVector<quint64> trigrams(const QString& normalizedName);
+
+    QSharedPointer<QFile> m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    int m_placeCount = 0;
+    int m_nameCount = 0;
+    int m_trigramCount = 0;
+    qint64 m_placesPosition = 0;
+    qint64 m_namesPosition = 0;
+    qint64 m_trigramsPosition = 0;
+    qint64 m_postingsPosition = 0;
+    qint64 m_stringsPosition = 0;
+};
+
+#endif // GAZETTEERINDEX_H
@@ -71,3 +71,13 @@ QString GdeltCalloutData::link() const
 {
     return m_link;
 }
+
+void GdeltCalloutData::setImageUrl(const QUrl &imageUrl)
+{
+    m_imageUrl = imageUrl;
+}
+
+QUrl GdeltCalloutData::imageUrl() const
+{
+    return m_imageUrl;
+}
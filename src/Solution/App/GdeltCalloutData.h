@@ -25,6 +25,7 @@
 #define GDELTCALLOUTDATA_H
 
 #include <QObject>
+#include <QUrl>
 
 class GdeltCalloutData : public QObject
 {
@@ -34,6 +35,7 @@ class GdeltCalloutData : public QObject
     Q_PROPERTY(QString title READ title)
     Q_PROPERTY(QString detail READ detail)
     Q_PROPERTY(QString link READ link)
+    Q_PROPERTY(QUrl imageUrl READ imageUrl)
 
 public:
     explicit GdeltCalloutData(QObject *parent = nullptr);
@@ -50,6 +52,9 @@ public:
     void setLink(const QString& link);
     QString link() const;
 
+    void setImageUrl(const QUrl& imageUrl);
+    QUrl imageUrl() const;
+
 signals:
 
 
@@ -58,6 +63,7 @@ private:
     QString m_title;
     QString m_detail;
     QString m_link;
+    QUrl m_imageUrl;
 };
 
 #endif // GDELTCALLOUTDATA_H
@@ -23,6 +23,12 @@
 //
 #include "GdeltEventLayer.h"
 
+#include "FeatureParsePipeline.h"
+#include "GdeltCalloutData.h"
+#include "GraphicsFactory.h"
+#include "ResponseCache.h"
+
+#include "CompositeSymbol.h"
 #include "FeatureCollectionTable.h"
 #include "GeometryEngine.h"
 #include "Graphic.h"
@@ -30,20 +36,49 @@
 #include "HeatmapRenderer.h"
 #include "SimpleMarkerSymbol.h"
 #include "SimpleRenderer.h"
+#include "TextSymbol.h"
 
+#include <QDateTime>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QNetworkReply>
-#include <QUuid>
+#include <QRegularExpression>
+#include <QtMath>
+
+#include <cmath>
 
 using namespace Esri::ArcGISRuntime;
 
+namespace
+{
+// Web Mercator grid cells of 100 km hold the event locations of the visible extent
+const double VirtualizerCellSize = 1e5;
+
+// The GDELT GEO API returns the events of the last 24 hours by default
+const qint64 QueryTimeSpan = 24 * 60 * 60 * 1000;
+
+QPointF toWebMercator(const Point& location)
+{
+    // Spherical Web Mercator of a WGS84 location
+    const double earthRadius = 6378137.0;
+    const double maxLatitude = 85.0511287798;
+    double latitude = qBound(-maxLatitude, location.y(), maxLatitude);
+    double x = earthRadius * qDegreesToRadians(location.x());
+    double y = earthRadius * std::log(std::tan(M_PI / 4 + qDegreesToRadians(latitude) / 2));
+    return QPointF(x, y);
+}
+}
+
 GdeltEventLayer::GdeltEventLayer(QObject *parent) :
     QObject(parent),
     m_networkAccessManager(new QNetworkAccessManager(this)),
-    m_overlay(new GraphicsOverlay(this))
+    m_parsePipeline(new FeatureParsePipeline(this)),
+    m_overlay(new GraphicsOverlay(this)),
+    m_clusterOverlay(new GraphicsOverlay(this)),
+    m_virtualizer(m_overlay, VirtualizerCellSize, [this](qint64 eventId) { return createGraphic(eventId); })
 {
     connect(m_networkAccessManager, &QNetworkAccessManager::finished, this, &GdeltEventLayer::networkRequestFinished);
+    connect(m_parsePipeline, &FeatureParsePipeline::featuresParsed, this, &GdeltEventLayer::featuresParsed);
 
     SimpleRenderer* gdeltRenderer = new SimpleRenderer(this);
     SimpleMarkerSymbol* gdeltSymbol = new SimpleMarkerSymbol(SimpleMarkerSymbolStyle::Circle, Qt::gray, 12, this);
@@ -52,6 +87,14 @@ GdeltEventLayer::GdeltEventLayer(QObject *parent) :
     m_simpleRenderer = gdeltRenderer;
     m_overlay->setRenderer(gdeltRenderer);
 
+    // Clusters of one event look like the simple rendered events
+    SimpleRenderer* clusterRenderer = new SimpleRenderer(this);
+    SimpleMarkerSymbol* clusterSymbol = new SimpleMarkerSymbol(SimpleMarkerSymbolStyle::Circle, Qt::gray, 12, this);
+    clusterSymbol->setOutline(new SimpleLineSymbol(SimpleLineSymbolStyle::Solid, Qt::black, 4, this));
+    clusterRenderer->setSymbol(clusterSymbol);
+    m_clusterOverlay->setRenderer(clusterRenderer);
+    m_clusterOverlay->setVisible(false);
+
     QJsonObject rendererJson;
     rendererJson.insert("type", "heatmap");
     rendererJson.insert("blurRadius", 10);
@@ -89,8 +132,14 @@ GdeltEventLayer::GdeltEventLayer(QObject *parent) :
     m_overlay->setPopupEnabled(true);
 }
 
+void GdeltEventLayer::setResponseCache(ResponseCache *responseCache)
+{
+    m_responseCache = responseCache;
+}
+
 void GdeltEventLayer::setHeatmapRendering(bool enabled)
 {
+    setClusterRendering(false);
     if (enabled)
     {
         m_overlay->setRenderer(m_heatMapRenderer);
@@ -101,6 +150,34 @@ void GdeltEventLayer::setHeatmapRendering(bool enabled)
     }
 }
 
+void GdeltEventLayer::setClusterRendering(bool enabled)
+{
+    m_clusterRendering = enabled;
+    if (enabled)
+    {
+        // The clusters are created from the event store
+        dropGraphics();
+    }
+    else
+    {
+        materializeGraphics(m_events.firstEventId());
+    }
+    m_overlay->setVisible(!enabled);
+    m_clusterOverlay->setVisible(enabled);
+    refreshClusters();
+}
+
+void GdeltEventLayer::updateVisibleExtent(const Envelope &visibleExtent, double unitsPerPixel)
+{
+    m_clusterExtent = visibleExtent;
+    m_unitsPerPixel = unitsPerPixel;
+    if (!visibleExtent.isEmpty())
+    {
+        m_virtualizer.setVisibleExtent(QRectF(QPointF(visibleExtent.xMin(), visibleExtent.yMin()), QPointF(visibleExtent.xMax(), visibleExtent.yMax())));
+    }
+    refreshClusters();
+}
+
 void GdeltEventLayer::setQueryFilter(const QString &filter)
 {
     m_queryFilter = filter;
@@ -116,142 +193,605 @@ GraphicsOverlay* GdeltEventLayer::overlay() const
     return m_overlay;
 }
 
+GraphicsOverlay* GdeltEventLayer::clusterOverlay() const
+{
+    return m_clusterOverlay;
+}
+
+bool GdeltEventLayer::clusterExtent(Graphic *clusterGraphic, Envelope &extent) const
+{
+    AttributeListModel* clusterAttributes = clusterGraphic->attributes();
+    if (!clusterAttributes->containsAttribute("count"))
+    {
+        return false;
+    }
+
+    extent = Envelope(clusterAttributes->attributeValue("xmin").toDouble(),
+                      clusterAttributes->attributeValue("ymin").toDouble(),
+                      clusterAttributes->attributeValue("xmax").toDouble(),
+                      clusterAttributes->attributeValue("ymax").toDouble(),
+                      SpatialReference::webMercator());
+    return true;
+}
+
 Graphic* GdeltEventLayer::findGraphic(const QString &graphicUid) const
 {
-    GraphicListModel* graphics = m_overlay->graphics();
-    int graphicCount = graphics->size();
-    for (int graphicIndex = 0; graphicIndex < graphicCount; graphicIndex++)
+    bool validUid = false;
+    qint64 eventId = graphicUid.toLongLong(&validUid);
+    return validUid ? m_virtualizer.graphic(eventId) : nullptr;
+}
+
+GdeltCalloutData* GdeltEventLayer::createCalloutData(const QString &graphicUid, QObject *parent) const
+{
+    bool validUid = false;
+    qint64 eventId = graphicUid.toLongLong(&validUid);
+    if (!validUid || !m_events.contains(eventId))
     {
-        Graphic* graphic = graphics->at(graphicIndex);
-        QVariant uniqueId = graphic->attributes()->attributeValue("uid");
-        if (!uniqueId.isNull() && 0 == uniqueId.toString().compare(graphicUid))
-        {
-            return graphic;
-        }
+        return nullptr;
+    }
+
+    // Only the dedicated fields are read, the html snippet only for events without a title
+    GdeltCalloutData* calloutData = new GdeltCalloutData(parent);
+    calloutData->setUniqueId(graphicUid);
+    calloutData->setTitle(m_events.value(eventId, "name").toString());
+    QString title = m_events.title(eventId);
+    calloutData->setDetail(title.isEmpty() ? m_events.value(eventId, "html").toString() : title);
+    calloutData->setLink(m_events.link(eventId));
+    calloutData->setImageUrl(QUrl(m_events.value(eventId, "shareimage").toString()));
+    return calloutData;
+}
+
+Point GdeltEventLayer::eventLocation(const QString &graphicUid) const
+{
+    bool validUid = false;
+    qint64 eventId = graphicUid.toLongLong(&validUid);
+    if (!validUid || !m_events.contains(eventId))
+    {
+        return Point();
     }
 
-    return nullptr;
+    return Point(m_events.x(eventId), m_events.y(eventId), SpatialReference::wgs84());
 }
 
 void GdeltEventLayer::query()
 {
-    QString nearFilter = "";
-    if (!m_spatialFilter.isEmpty())
-    {
-        //TODO: Using center point having a coordinate equal 0.0 causes GDELT error!
-        Point center = m_spatialFilter.center();
-        nearFilter = "near:"
-                + QString::number(center.y())
-                + ","
-                + QString::number(center.x());
-        Point lowerLeft = Point(m_spatialFilter.xMin(), m_spatialFilter.yMin(), m_spatialFilter.spatialReference());
-        Point upperRight = Point(m_spatialFilter.xMax(), m_spatialFilter.yMax(), m_spatialFilter.spatialReference());
-        GeodeticDistanceResult distanceResult = GeometryEngine::distanceGeodetic(lowerLeft, upperRight, LinearUnit::kilometers(), AngularUnit::degrees(), GeodeticCurveType::Geodesic);
-        double searchDistance = distanceResult.distance();
-        if (200 < searchDistance)
+    startQuery(true);
+}
+
+void GdeltEventLayer::refresh()
+{
+    // Cached responses would hide the events published since the last refresh
+    startQuery(false);
+}
+
+void GdeltEventLayer::setEventTimeWindow(int seconds)
+{
+    m_eventTimeWindow = seconds;
+    removeExpiredEvents();
+    refreshClusters();
+}
+
+void GdeltEventLayer::startQuery(bool useCache)
+{
+    quint64 generation = m_parsePipeline->supersede();
+    m_useCache = useCache;
+    m_pendingQueryUrls.clear();
+    m_runningQueryCount = 0;
+    m_parsingQueryCount = 0;
+    m_queryTime = QDateTime::currentMSecsSinceEpoch();
+    m_queryNewEventCount = 0;
+
+    QStringList nearFilters = createNearFilters();
+    if (nearFilters.isEmpty())
+    {
+        // No spatial filter
+        nearFilters.append("");
+    }
+
+    foreach (const QString& nearFilter, nearFilters)
+    {
+        QString spatialFilter = nearFilter;
+        if (!spatialFilter.isEmpty() && !m_queryFilter.isEmpty())
         {
-            //TODO: Search distances more than 200 kilometers are not supported by GDELT!
-            searchDistance = 200;
+            spatialFilter = " AND " + spatialFilter;
         }
 
-        // Search distance must be an integer
-        nearFilter += ","
-            + QString::number(int(searchDistance))
-            + "km";
-        if (!m_queryFilter.isEmpty())
+        QString gdeltQueryString = "https://api.gdeltproject.org/api/v2/geo/geo?query="
+                + m_queryFilter
+                + spatialFilter
+                + "&format=geojson";
+        m_pendingQueryUrls.enqueue(QUrl(gdeltQueryString));
+    }
+
+    startPendingQueries(generation);
+}
+
+QStringList GdeltEventLayer::createNearFilters() const
+{
+    QStringList nearFilters;
+    if (m_spatialFilter.isEmpty())
+    {
+        return nearFilters;
+    }
+
+    // Search distances more than 200 kilometers are not supported by GDELT!
+    // The extent is covered by a grid of cells and every cell by one search circle.
+    const double maxSearchDistance = 200;
+    const double maxCellSize = 270;
+    const double kilometersPerDegree = 111.32;
+    const int maxCellCount = 64;
+
+    double xMin = m_spatialFilter.xMin();
+    double yMin = m_spatialFilter.yMin();
+    double xMax = m_spatialFilter.xMax();
+    double yMax = m_spatialFilter.yMax();
+    SpatialReference spatialReference = m_spatialFilter.spatialReference();
+
+    // The widest parallel of the extent is the one closest to the equator
+    double widestLatitude = (yMin <= 0 && 0 <= yMax) ? 0 : qMin(qAbs(yMin), qAbs(yMax));
+    double widthInKilometers = (xMax - xMin) * kilometersPerDegree * qCos(qDegreesToRadians(widestLatitude));
+    double heightInKilometers = (yMax - yMin) * kilometersPerDegree;
+    int columnCount = qMax(1, qCeil(widthInKilometers / maxCellSize));
+    int rowCount = qMax(1, qCeil(heightInKilometers / maxCellSize));
+    if (maxCellCount < columnCount * rowCount)
+    {
+        // Coarser cells would need search circles beyond the supported distance and leave gaps,
+        // the coarsest grid is a single query without a spatial filter clipped to the extent when ingested.
+        return nearFilters;
+    }
+
+    double cellWidth = (xMax - xMin) / columnCount;
+    double cellHeight = (yMax - yMin) / rowCount;
+    for (int rowIndex = 0; rowIndex < rowCount; rowIndex++)
+    {
+        double cellYMin = yMin + rowIndex * cellHeight;
+        double cellYMax = cellYMin + cellHeight;
+        for (int columnIndex = 0; columnIndex < columnCount; columnIndex++)
         {
-            nearFilter = " AND " + nearFilter;
+            double cellXMin = xMin + columnIndex * cellWidth;
+            double cellXMax = cellXMin + cellWidth;
+
+            //TODO: Using center point having a coordinate equal 0.0 causes GDELT error!
+            Point center(0.5 * (cellXMin + cellXMax), 0.5 * (cellYMin + cellYMax), spatialReference);
+
+            // The corner closest to the equator is the farthest one
+            double cornerY = (qAbs(cellYMin) < qAbs(cellYMax)) ? cellYMin : cellYMax;
+            Point corner(cellXMin, cornerY, spatialReference);
+            GeodeticDistanceResult distanceResult = GeometryEngine::distanceGeodetic(center, corner, LinearUnit::kilometers(), AngularUnit::degrees(), GeodeticCurveType::Geodesic);
+            double searchDistance = qMin(maxSearchDistance, qCeil(distanceResult.distance()) * 1.0);
+
+            // Search distance must be an integer
+            QString nearFilter = "near:"
+                    + QString::number(center.y())
+                    + ","
+                    + QString::number(center.x())
+                    + ","
+                    + QString::number(qMax(1, int(searchDistance)))
+                    + "km";
+            nearFilters.append(nearFilter);
         }
     }
 
-    QString gdeltQueryString = "https://api.gdeltproject.org/api/v2/geo/geo?query="
-            + m_queryFilter
-            + nearFilter
-            + "&format=geojson";
-    QUrl gdeltQueryUrl(gdeltQueryString);
+    return nearFilters;
+}
+
+void GdeltEventLayer::startPendingQueries(quint64 generation)
+{
+    // Bounded number of concurrent requests against the GDELT service
+    const int maxRunningQueryCount = 4;
+    while (m_runningQueryCount < maxRunningQueryCount && !m_pendingQueryUrls.isEmpty())
+    {
+        QUrl gdeltQueryUrl = m_pendingQueryUrls.dequeue();
+        QByteArray cachedResponse;
+        if (m_responseCache && m_useCache && m_responseCache->lookup("gdelt", gdeltQueryUrl, cachedResponse))
+        {
+            parseResponse(generation, cachedResponse);
+            continue;
+        }
+        if (m_responseCache && m_responseCache->isCacheOnly())
+        {
+            qDebug() << "GDELT query is not cached!";
+            continue;
+        }
 
-    QNetworkRequest gdeltRequest;
-    gdeltRequest.setUrl(gdeltQueryUrl);
-    m_networkAccessManager->get(gdeltRequest);
+        QNetworkRequest gdeltRequest;
+        gdeltRequest.setUrl(gdeltQueryUrl);
+        m_parsePipeline->trackRequest(gdeltRequest, generation);
+        m_parsePipeline->trackReply(m_networkAccessManager->get(gdeltRequest));
+        m_runningQueryCount++;
+    }
+
+    finishQuery();
 }
 
 void GdeltEventLayer::networkRequestFinished(QNetworkReply* reply)
 {
+    reply->deleteLater();
+    quint64 generation = FeatureParsePipeline::requestGeneration(reply);
+    if (!m_parsePipeline->isCurrent(generation))
+    {
+        // Superseded by a newer query
+        return;
+    }
+
+    m_runningQueryCount--;
     if (reply->error())
     {
         qDebug() << reply->errorString();
+    }
+    else
+    {
+        QByteArray jsonResponse = reply->readAll();
+        if (m_responseCache)
+        {
+            m_responseCache->insert("gdelt", reply->request().url(), jsonResponse);
+        }
+        parseResponse(generation, jsonResponse);
+    }
+
+    startPendingQueries(generation);
+}
+
+void GdeltEventLayer::parseResponse(quint64 generation, const QByteArray &jsonResponse)
+{
+    m_parsingQueryCount++;
+    m_parsePipeline->submit(generation, [jsonResponse](const CancelCheck& isCanceled)
+    {
+        return GraphicsFactory::parseFeatureCollection(jsonResponse, isCanceled);
+    });
+}
+
+void GdeltEventLayer::featuresParsed(quint64 generation, const ParsedFeatureList &features)
+{
+    Q_UNUSED(generation);
+
+    // Every cell is merged as soon as it arrives, the dedup set drops the events of overlapping circles
+    m_parsingQueryCount--;
+    ingestFeatures(features);
+    finishQuery();
+}
+
+void GdeltEventLayer::ingestFeatures(const ParsedFeatureList &features)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 firstNewEventId = m_events.endEventId();
+    int newEventCount = 0;
+    foreach (const ParsedFeature& feature, features)
+    {
+        if (GeometryType::Point != feature.geometry.geometryType())
+        {
+            continue;
+        }
+
+        // Events beyond the spatial filter are returned by the query without a spatial filter
+        Point location = static_cast<Point>(feature.geometry);
+        if (!m_spatialFilter.isEmpty() && !containsLocation(m_spatialFilter, location))
+        {
+            continue;
+        }
+
+        // Check if an event is refering to the same news
+        QString eventKeyValue = eventKey(feature.attributes);
+        quint64 eventKeyHashValue = eventKeyHash(eventKeyValue);
+        if (containsEventKey(eventKeyValue, eventKeyHashValue))
+        {
+            continue;
+        }
+
+        // Expired events returned again must not come back as new ones
+        auto expiredEventKey = m_expiredEventKeys.find(eventKeyValue);
+        if (m_expiredEventKeys.end() != expiredEventKey)
+        {
+            if (m_queryTime != expiredEventKey.value())
+            {
+                expiredEventKey.value() = m_queryTime;
+                m_expiredEventKeyQueue.enqueue(ExpiredEventKey { eventKeyValue, m_queryTime });
+            }
+            continue;
+        }
+
+        // The callout fields are extracted once for every new event
+        QString title;
+        QString link;
+        extractCalloutFields(feature.attributes.value("html").toString(), title, link);
+
+        qint64 eventId = m_events.append(location.x(), location.y(), feature.attributes, eventKeyHashValue, now, title, link);
+        if (0 != eventKeyHashValue)
+        {
+            m_eventIdsByKeyHash.insert(eventKeyHashValue, eventId);
+        }
+        m_clusterIndex.insert(QString::number(eventId), toWebMercator(location));
+        newEventCount++;
+    }
+
+    if (!m_clusterRendering)
+    {
+        materializeGraphics(firstNewEventId);
+    }
+
+    m_queryNewEventCount += newEventCount;
+}
+
+void GdeltEventLayer::finishQuery()
+{
+    if (0 < m_runningQueryCount || !m_pendingQueryUrls.isEmpty() || 0 < m_parsingQueryCount)
+    {
         return;
     }
 
-    QByteArray jsonResponse = reply->readAll();
-    QJsonDocument gdeltEventsDocument = QJsonDocument::fromJson(jsonResponse);
-    if (gdeltEventsDocument.isNull())
+    // Events expire, the clusters are rebuilt and the new events are notified once for all sub-queries
+    removeExpiredEvents();
+    refreshClusters();
+    emit eventsAdded(m_queryNewEventCount);
+}
+
+void GdeltEventLayer::removeExpiredEvents()
+{
+    if (m_eventTimeWindow <= 0)
     {
-        qDebug() << "JSON is invalid!";
+        m_expiredEventKeys.clear();
+        m_expiredEventKeyQueue.clear();
         return;
     }
-    if (!gdeltEventsDocument.isObject())
+
+    // Keys the query has not returned for its whole time span are never returned again,
+    // a key returned again is only dropped with its latest entry
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    while (!m_expiredEventKeyQueue.isEmpty() && m_expiredEventKeyQueue.head().returnedTime < now - QueryTimeSpan)
+    {
+        ExpiredEventKey expiredEventKey = m_expiredEventKeyQueue.dequeue();
+        auto expiredEventKeyIterator = m_expiredEventKeys.find(expiredEventKey.key);
+        if (m_expiredEventKeys.end() != expiredEventKeyIterator && expiredEventKey.returnedTime == expiredEventKeyIterator.value())
+        {
+            m_expiredEventKeys.erase(expiredEventKeyIterator);
+        }
+    }
+
+    // Only the oldest live events are visited
+    qint64 expirationTime = now - 1000 * qint64(m_eventTimeWindow);
+    qint64 endEventId = m_events.endEventId();
+    for (qint64 eventId = m_events.firstLiveEventId(); eventId < endEventId; eventId++)
+    {
+        if (!m_events.contains(eventId))
+        {
+            continue;
+        }
+        if (expirationTime <= m_events.seenTime(eventId))
+        {
+            break;
+        }
+
+        // The key outlives the event until the query stops returning it
+        if (0 != m_events.keyHash(eventId))
+        {
+            QString eventKeyValue = storedEventKey(eventId);
+            m_expiredEventKeys.insert(eventKeyValue, now);
+            m_expiredEventKeyQueue.enqueue(ExpiredEventKey { eventKeyValue, now });
+        }
+        removeEvent(eventId);
+    }
+}
+
+void GdeltEventLayer::refreshClusters()
+{
+    m_clusterOverlay->graphics()->clear();
+    qDeleteAll(m_clusterGraphics);
+    m_clusterGraphics.clear();
+    if (!m_clusterRendering || m_clusterExtent.isEmpty() || m_unitsPerPixel <= 0)
     {
-        qDebug() << "JSON document is not an object!";
         return;
     }
 
-    QJsonObject gdeltEventsObject = gdeltEventsDocument.object();
-    QJsonArray gdeltFeaturesArray = gdeltEventsObject["features"].toArray();
-    foreach (const QJsonValue& featureValue, gdeltFeaturesArray)
+    // One cluster per cell of about this size on the screen
+    const double clusterSizeInPixels = 64;
+    QRectF visibleExtent(m_clusterExtent.xMin(), m_clusterExtent.yMin(), m_clusterExtent.width(), m_clusterExtent.height());
+    QList<EventClusterIndex::Cluster> clusters = m_clusterIndex.clusters(clusterSizeInPixels * m_unitsPerPixel, visibleExtent);
+    foreach (const EventClusterIndex::Cluster& cluster, clusters)
     {
-        if (featureValue.isObject())
+        Point clusterCenter(cluster.center.x(), cluster.center.y(), SpatialReference::webMercator());
+        Graphic* clusterGraphic = nullptr;
+        if (1 == cluster.count)
         {
-            QJsonObject gdeltFeature = featureValue.toObject();
-            QJsonObject gdeltFeatureGeometry = gdeltFeature["geometry"].toObject();
-            QJsonValue geometryTypeValue = gdeltFeatureGeometry["type"];
-            if (geometryTypeValue.isString())
-            {
-                QString geometryType = geometryTypeValue.toString();
-                if (0 == QString::compare("Point", geometryType))
-                {
-                    QJsonValue coordinatesValue = gdeltFeatureGeometry["coordinates"];
-                    if (coordinatesValue.isArray())
-                    {
-                        QJsonArray coordinatesArray = coordinatesValue.toArray();
-                        if (1 < coordinatesArray.count())
-                        {
-                            double x = coordinatesArray[0].toDouble();
-                            double y = coordinatesArray[1].toDouble();
-                            QJsonObject properties = gdeltFeature["properties"].toObject();
-                            QVariantMap propertyMap = properties.toVariantMap();
-                            bool eventIsNew = true;
-                            if (propertyMap.contains("html")) {
-                                // Check if a graphic is refering to the same event
-                                QString eventHtmlValue = propertyMap.value("html").toString();
-                                GraphicListModel* graphics = m_overlay->graphics();
-                                int graphicCount = graphics->size();
-                                for (int graphicIndex = 0; graphicIndex < graphicCount; graphicIndex++)
-                                {
-                                    Graphic* existingGraphic = graphics->at(graphicIndex);
-                                    QString existingHtmlValue = existingGraphic->attributes()->attributeValue("html").toString();
-                                    if (0 == eventHtmlValue.compare(existingHtmlValue))
-                                    {
-                                        // Html is already used by an existing graphic
-                                        eventIsNew = false;
-                                        break;
-                                    }
-                                }
-                            }
-
-                            if (eventIsNew)
-                            {
-                                Point location(x, y, SpatialReference::wgs84());
-                                Graphic* gdeltGraphic = new Graphic(location, propertyMap, this);
-                                QUuid uniqueId = QUuid::createUuid();
-                                gdeltGraphic->attributes()->insertAttribute("uid", uniqueId.toString());
-                                m_overlay->graphics()->append(gdeltGraphic);
-                            }
-                        }
-                    }
-                }
-            }
+            clusterGraphic = new Graphic(clusterCenter, this);
+            clusterGraphic->attributes()->insertAttribute("uid", cluster.id);
+        }
+        else
+        {
+            QVariantMap clusterAttributes;
+            clusterAttributes.insert("count", cluster.count);
+            clusterAttributes.insert("xmin", cluster.cellBounds.left());
+            clusterAttributes.insert("ymin", cluster.cellBounds.top());
+            clusterAttributes.insert("xmax", cluster.cellBounds.right());
+            clusterAttributes.insert("ymax", cluster.cellBounds.bottom());
+            clusterGraphic = new Graphic(clusterCenter, clusterAttributes, this);
+            clusterGraphic->setSymbol(createClusterSymbol(cluster.count, clusterGraphic));
+        }
+        m_clusterGraphics.append(clusterGraphic);
+    }
+
+    if (!m_clusterGraphics.isEmpty())
+    {
+        m_clusterOverlay->graphics()->append(m_clusterGraphics);
+    }
+}
+
+Symbol* GdeltEventLayer::createClusterSymbol(int count, QObject *parent)
+{
+    // Marker size grows with the order of magnitude of the event count
+    float markerSize = 18 + 6 * float(std::log10(count));
+    SimpleMarkerSymbol* markerSymbol = new SimpleMarkerSymbol(SimpleMarkerSymbolStyle::Circle, QColor("#a7ad6d"), markerSize, parent);
+    markerSymbol->setOutline(new SimpleLineSymbol(SimpleLineSymbolStyle::Solid, Qt::black, 2, parent));
+    TextSymbol* countSymbol = new TextSymbol(QString::number(count), Qt::black, 11, HorizontalAlignment::Center, VerticalAlignment::Middle, parent);
+    QList<Symbol*> symbols;
+    symbols.append(markerSymbol);
+    symbols.append(countSymbol);
+    return new CompositeSymbol(symbols, parent);
+}
+
+void GdeltEventLayer::clear()
+{
+    dropGraphics();
+    m_events.clear();
+    m_eventIdsByKeyHash.clear();
+    m_expiredEventKeys.clear();
+    m_expiredEventKeyQueue.clear();
+    m_clusterIndex.clear();
+    refreshClusters();
+}
+
+bool GdeltEventLayer::removeSelectedGraphics()
+{
+    // Events can be selected as graphics or as clusters of one event
+    QList<Graphic*> selectedGraphics = m_overlay->selectedGraphics();
+    selectedGraphics.append(m_clusterOverlay->selectedGraphics());
+    QList<qint64> selectedEventIds;
+    foreach (Graphic* selectedGraphic, selectedGraphics)
+    {
+        bool validUid = false;
+        qint64 eventId = selectedGraphic->attributes()->attributeValue("uid").toLongLong(&validUid);
+        if (validUid)
+        {
+            selectedEventIds.append(eventId);
+        }
+    }
+
+    foreach (qint64 eventId, selectedEventIds)
+    {
+        removeEvent(eventId);
+    }
+
+    bool removedGraphic = !selectedEventIds.isEmpty();
+    if (removedGraphic)
+    {
+        refreshClusters();
+    }
+
+    return removedGraphic;
+}
+
+void GdeltEventLayer::materializeGraphics(qint64 firstEventId)
+{
+    // Only the events within the visible extent get a graphic
+    qint64 endEventId = m_events.endEventId();
+    for (qint64 eventId = qMax(firstEventId, m_events.firstEventId()); eventId < endEventId; eventId++)
+    {
+        if (!m_events.contains(eventId) || m_virtualizer.contains(eventId))
+        {
+            continue;
         }
+
+        Point location(m_events.x(eventId), m_events.y(eventId), SpatialReference::wgs84());
+        m_virtualizer.insert(eventId, QRectF(toWebMercator(location), QSizeF()));
+    }
+    m_virtualizer.commit();
+}
+
+Graphic* GdeltEventLayer::createGraphic(qint64 eventId)
+{
+    // The properties are read from the event store when needed
+    QVariantMap graphicAttributes;
+    graphicAttributes.insert("uid", QString::number(eventId));
+    Point location(m_events.x(eventId), m_events.y(eventId), SpatialReference::wgs84());
+    return new Graphic(location, graphicAttributes, this);
+}
+
+void GdeltEventLayer::dropGraphics()
+{
+    m_virtualizer.clear();
+}
+
+void GdeltEventLayer::removeEvent(qint64 eventId)
+{
+    if (!m_events.contains(eventId))
+    {
+        return;
+    }
+
+    QString uniqueId = QString::number(eventId);
+    m_virtualizer.remove(eventId);
+
+    quint64 eventKeyHashValue = m_events.keyHash(eventId);
+    if (0 != eventKeyHashValue)
+    {
+        m_eventIdsByKeyHash.remove(eventKeyHashValue, eventId);
+    }
+    m_clusterIndex.remove(uniqueId);
+    m_events.remove(eventId);
+}
+
+bool GdeltEventLayer::containsLocation(const Envelope &extent, const Point &location)
+{
+    return extent.xMin() <= location.x() && location.x() <= extent.xMax()
+            && extent.yMin() <= location.y() && location.y() <= extent.yMax();
+}
+
+QString GdeltEventLayer::eventKey(const QVariantMap &propertyMap)
+{
+    // The html snippet contains the news article links of an event
+    return propertyMap.value("html").toString();
+}
+
+QString GdeltEventLayer::storedEventKey(qint64 eventId) const
+{
+    return m_events.value(eventId, "html").toString();
+}
+
+bool GdeltEventLayer::containsEventKey(const QString &eventKeyValue, quint64 eventKeyHashValue) const
+{
+    if (0 == eventKeyHashValue)
+    {
+        return false;
+    }
+
+    // A matching hash is only a candidate, the stored key decides
+    for (auto eventIdIterator = m_eventIdsByKeyHash.constFind(eventKeyHashValue);
+         m_eventIdsByKeyHash.constEnd() != eventIdIterator && eventKeyHashValue == eventIdIterator.key();
+         ++eventIdIterator)
+    {
+        if (eventKeyValue == storedEventKey(eventIdIterator.value()))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+quint64 GdeltEventLayer::eventKeyHash(const QString &eventKeyValue)
+{
+    if (eventKeyValue.isEmpty())
+    {
+        return 0;
+    }
+
+    // 64-bit FNV-1a, zero means no key
+    quint64 hashValue = Q_UINT64_C(14695981039346656037);
+    const ushort* data = eventKeyValue.utf16();
+    for (int index = 0; index < eventKeyValue.length(); index++)
+    {
+        hashValue ^= data[index];
+        hashValue *= Q_UINT64_C(1099511628211);
+    }
+    return (0 != hashValue) ? hashValue : 1;
+}
+
+void GdeltEventLayer::extractCalloutFields(const QString &html, QString &title, QString &link)
+{
+    // Compiled once and shared by all ingests
+    static const QRegularExpression titlePattern("title=\"(?<title>[^\"]+)\"");
+    static const QRegularExpression hrefPattern("href=\"(?<href>[^\"]+)\"");
+
+    QRegularExpressionMatch titleMatch = titlePattern.match(html);
+    if (titleMatch.hasMatch())
+    {
+        // Events without a title do not store the html snippet twice
+        title = titleMatch.captured("title");
+    }
+
+    QRegularExpressionMatch hrefMatch = hrefPattern.match(html);
+    if (hrefMatch.hasMatch())
+    {
+        // The news url
+        link = hrefMatch.captured("href");
     }
 }
 
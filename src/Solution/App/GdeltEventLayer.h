@@ -25,6 +25,11 @@
 #define GDELTEVENTLAYER_H
 
 #include "Envelope.h"
+#include "EventClusterIndex.h"
+#include "GdeltEventStore.h"
+#include "OverlayVirtualizer.h"
+#include "ParsedFeature.h"
+#include "Point.h"
 
 namespace Esri
 {
@@ -34,13 +39,20 @@ class FeatureCollectionTable;
 class GraphicsOverlay;
 class Graphic;
 class Renderer;
+class Symbol;
 }
 }
 
+class FeatureParsePipeline;
+class GdeltCalloutData;
+class ResponseCache;
 class QNetworkReply;
 
+#include <QHash>
 #include <QNetworkAccessManager>
 #include <QObject>
+#include <QQueue>
+#include <QUrl>
 
 class GdeltEventLayer : public QObject
 {
@@ -48,33 +60,133 @@ class GdeltEventLayer : public QObject
 public:
     explicit GdeltEventLayer(QObject *parent = nullptr);
 
+    void setResponseCache(ResponseCache* responseCache);
+
     void setHeatmapRendering(bool enabled);
 
+    void setClusterRendering(bool enabled);
+
+    void updateVisibleExtent(const Esri::ArcGISRuntime::Envelope& visibleExtent, double unitsPerPixel);
+
     void setQueryFilter(const QString& filter);
 
     void setSpatialFilter(const Esri::ArcGISRuntime::Envelope &extent);
 
     Esri::ArcGISRuntime::GraphicsOverlay* overlay() const;
+    Esri::ArcGISRuntime::GraphicsOverlay* clusterOverlay() const;
+
+    bool clusterExtent(Esri::ArcGISRuntime::Graphic* clusterGraphic, Esri::ArcGISRuntime::Envelope& extent) const;
 
     Esri::ArcGISRuntime::Graphic* findGraphic(const QString& graphicUid) const;
 
+    GdeltCalloutData* createCalloutData(const QString& graphicUid, QObject* parent) const;
+    Esri::ArcGISRuntime::Point eventLocation(const QString& graphicUid) const;
+
     void query();
 
+    void refresh();
+
+    void setEventTimeWindow(int seconds);
+
+    void clear();
+
+    bool removeSelectedGraphics();
+
 signals:
+    void eventsAdded(int newEventCount);
 
 private slots:
     void networkRequestFinished(QNetworkReply* reply);
+    void featuresParsed(quint64 generation, const ParsedFeatureList& features);
 
 private:
     Esri::ArcGISRuntime::FeatureCollectionTable* createTable();
 
+    void startQuery(bool useCache);
+
+    QStringList createNearFilters() const;
+
+    void startPendingQueries(quint64 generation);
+
+    void parseResponse(quint64 generation, const QByteArray& jsonResponse);
+
+    void ingestFeatures(const ParsedFeatureList& features);
+
+    void finishQuery();
+
+    static bool containsLocation(const Esri::ArcGISRuntime::Envelope& extent, const Esri::ArcGISRuntime::Point& location);
+
+    void removeExpiredEvents();
+
+    void refreshClusters();
+
+    Esri::ArcGISRuntime::Symbol* createClusterSymbol(int count, QObject* parent);
+
+    void materializeGraphics(qint64 firstEventId);
+
+    Esri::ArcGISRuntime::Graphic* createGraphic(qint64 eventId);
+
+    void dropGraphics();
+
+    void removeEvent(qint64 eventId);
+
+    static QString eventKey(const QVariantMap& propertyMap);
+
+    QString storedEventKey(qint64 eventId) const;
+
+    bool containsEventKey(const QString& eventKeyValue, quint64 eventKeyHashValue) const;
+
+    static quint64 eventKeyHash(const QString& eventKeyValue);
+
+    static void extractCalloutFields(const QString& html, QString& title, QString& link);
+
     QNetworkAccessManager* m_networkAccessManager = nullptr;
+    FeatureParsePipeline* m_parsePipeline = nullptr;
+    ResponseCache* m_responseCache = nullptr;
     Esri::ArcGISRuntime::GraphicsOverlay* m_overlay = nullptr;
     Esri::ArcGISRuntime::Renderer* m_simpleRenderer = nullptr;
     Esri::ArcGISRuntime::Renderer* m_heatMapRenderer = nullptr;
+    Esri::ArcGISRuntime::GraphicsOverlay* m_clusterOverlay = nullptr;
 
     QString m_queryFilter;
     Esri::ArcGISRuntime::Envelope m_spatialFilter;
+
+    // Sub-queries covering the spatial filter
+    QQueue<QUrl> m_pendingQueryUrls;
+    int m_runningQueryCount = 0;
+    int m_parsingQueryCount = 0;
+    bool m_useCache = true;
+
+    // Start time and new events of the running query, summed over its sub-queries
+    qint64 m_queryTime = 0;
+    int m_queryNewEventCount = 0;
+
+    // Events ordered by the time they were first seen, the event id is the unique id
+    GdeltEventStore m_events;
+    int m_eventTimeWindow = 0;
+
+    // Event ids by the hash of their event key, colliding keys share a hash
+    QMultiHash<quint64, qint64> m_eventIdsByKeyHash;
+
+    // Keys of expired events the query may still return by the time they were last returned,
+    // queued in the order of that time, a key returned again is queued again
+    struct ExpiredEventKey
+    {
+        QString key;
+        qint64 returnedTime;
+    };
+    QHash<QString, qint64> m_expiredEventKeys;
+    QQueue<ExpiredEventKey> m_expiredEventKeyQueue;
+
+    // Graphics are only materialized while the overlay is visible, and only for the visible extent
+    OverlayVirtualizer m_virtualizer;
+
+    // Event locations in Web Mercator and the cluster graphics of the last visible extent
+    EventClusterIndex m_clusterIndex;
+    QList<Esri::ArcGISRuntime::Graphic*> m_clusterGraphics;
+    Esri::ArcGISRuntime::Envelope m_clusterExtent;
+    double m_unitsPerPixel = 0;
+    bool m_clusterRendering = false;
 };
 
 #endif // GDELTEVENTLAYER_H
@@ -0,0 +1,303 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "GdeltEventStore.h"
+
+GdeltEventStore::GdeltEventStore()
+{
+}
+
+qint64 GdeltEventStore::append(double x, double y, const QVariantMap &properties, quint64 keyHash, qint64 seenTime,
+                               const QString &title, const QString &link)
+{
+    int row = m_x.count();
+    m_x.append(x);
+    m_y.append(y);
+    m_keyHashes.append(keyHash);
+    m_seenTimes.append(seenTime);
+    m_alive.resize(row + 1);
+    m_alive.setBit(row);
+    m_titles.append(appendString(title));
+    m_links.append(appendString(link));
+    for (int keyIndex = 0; keyIndex < m_columns.count(); keyIndex++)
+    {
+        m_columns[keyIndex].append(0);
+    }
+
+    for (auto propertyIterator = properties.constBegin(); propertyIterator != properties.constEnd(); ++propertyIterator)
+    {
+        const QVariant& propertyValue = propertyIterator.value();
+        int keyIndex = internKey(propertyIterator.key(), propertyValue.userType());
+        m_columns[keyIndex][row] = appendString(propertyValue.toString()) + 1;
+    }
+
+    m_count++;
+    return m_firstEventId + row;
+}
+
+void GdeltEventStore::remove(qint64 eventId)
+{
+    if (!contains(eventId))
+    {
+        return;
+    }
+
+    m_alive.clearBit(rowOf(eventId));
+    m_count--;
+    compactFront();
+}
+
+bool GdeltEventStore::contains(qint64 eventId) const
+{
+    int row = rowOf(eventId);
+    return 0 <= row && row < m_x.count() && m_alive.testBit(row);
+}
+
+void GdeltEventStore::clear()
+{
+    // Event and string ids are never reused
+    m_firstEventId += m_x.count();
+    m_firstStringId += quint32(m_stringOffsets.count());
+    m_x.clear();
+    m_y.clear();
+    m_keyHashes.clear();
+    m_seenTimes.clear();
+    m_alive.clear();
+    m_titles.clear();
+    m_links.clear();
+    for (int keyIndex = 0; keyIndex < m_columns.count(); keyIndex++)
+    {
+        m_columns[keyIndex].clear();
+    }
+    m_stringPool.clear();
+    m_stringOffsets.clear();
+    m_deadFrontCount = 0;
+    m_count = 0;
+}
+
+int GdeltEventStore::count() const
+{
+    return m_count;
+}
+
+qint64 GdeltEventStore::firstEventId() const
+{
+    return m_firstEventId;
+}
+
+qint64 GdeltEventStore::firstLiveEventId() const
+{
+    // Every remove scans the dead prefix forward
+    return m_firstEventId + m_deadFrontCount;
+}
+
+qint64 GdeltEventStore::endEventId() const
+{
+    return m_firstEventId + m_x.count();
+}
+
+double GdeltEventStore::x(qint64 eventId) const
+{
+    return m_x.at(rowOf(eventId));
+}
+
+double GdeltEventStore::y(qint64 eventId) const
+{
+    return m_y.at(rowOf(eventId));
+}
+
+quint64 GdeltEventStore::keyHash(qint64 eventId) const
+{
+    return m_keyHashes.at(rowOf(eventId));
+}
+
+qint64 GdeltEventStore::seenTime(qint64 eventId) const
+{
+    return m_seenTimes.at(rowOf(eventId));
+}
+
+QString GdeltEventStore::title(qint64 eventId) const
+{
+    return string(m_titles.at(rowOf(eventId)));
+}
+
+QString GdeltEventStore::link(qint64 eventId) const
+{
+    return string(m_links.at(rowOf(eventId)));
+}
+
+QVariant GdeltEventStore::value(qint64 eventId, const QString &key) const
+{
+    int keyIndex = m_keyIndices.value(key, -1);
+    if (-1 == keyIndex || !contains(eventId))
+    {
+        return QVariant();
+    }
+
+    quint32 storedId = m_columns[keyIndex].at(rowOf(eventId));
+    if (0 == storedId)
+    {
+        return QVariant();
+    }
+
+    int valueType = m_keyTypes.at(keyIndex);
+    if (QMetaType::UnknownType == valueType)
+    {
+        return QVariant();
+    }
+
+    QVariant propertyValue(string(storedId - 1));
+    if (QMetaType::QString != valueType)
+    {
+        propertyValue.convert(valueType);
+    }
+    return propertyValue;
+}
+
+QVariantMap GdeltEventStore::properties(qint64 eventId) const
+{
+    QVariantMap propertyMap;
+    if (!contains(eventId))
+    {
+        return propertyMap;
+    }
+
+    int row = rowOf(eventId);
+    for (int keyIndex = 0; keyIndex < m_keys.count(); keyIndex++)
+    {
+        if (0 != m_columns[keyIndex].at(row))
+        {
+            propertyMap.insert(m_keys.at(keyIndex), value(eventId, m_keys.at(keyIndex)));
+        }
+    }
+    return propertyMap;
+}
+
+int GdeltEventStore::internKey(const QString &key, int type)
+{
+    int keyIndex = m_keyIndices.value(key, -1);
+    if (-1 != keyIndex)
+    {
+        if (QMetaType::UnknownType == m_keyTypes[keyIndex])
+        {
+            m_keyTypes[keyIndex] = type;
+        }
+        return keyIndex;
+    }
+
+    keyIndex = m_keys.count();
+    m_keys.append(key);
+    m_keyIndices.insert(key, keyIndex);
+    m_keyTypes.append(type);
+    m_columns.append(QVector<quint32>(m_x.count(), 0));
+    return keyIndex;
+}
+
+quint32 GdeltEventStore::appendString(const QString &value)
+{
+    quint32 stringId = m_firstStringId + quint32(m_stringOffsets.count());
+    m_stringOffsets.append(quint32(m_stringPool.size()));
+    m_stringPool.append(value.toUtf8());
+    return stringId;
+}
+
+QString GdeltEventStore::string(quint32 stringId) const
+{
+    int stringIndex = int(stringId - m_firstStringId);
+    int start = int(m_stringOffsets.at(stringIndex));
+    int end = (stringIndex + 1 < m_stringOffsets.count()) ? int(m_stringOffsets.at(stringIndex + 1)) : m_stringPool.size();
+    return QString::fromUtf8(m_stringPool.constData() + start, end - start);
+}
+
+int GdeltEventStore::rowOf(qint64 eventId) const
+{
+    return int(eventId - m_firstEventId);
+}
+
+void GdeltEventStore::compactFront()
+{
+    // Events are removed mostly from the front when they age out
+    const int minCompactRowCount = 4096;
+    // The dead prefix only grows until it is compacted, it is scanned once
+    int rowCount = m_x.count();
+    while (m_deadFrontCount < rowCount && !m_alive.testBit(m_deadFrontCount))
+    {
+        m_deadFrontCount++;
+    }
+
+    int deadRowCount = m_deadFrontCount;
+    if (deadRowCount < minCompactRowCount && 4 * deadRowCount < rowCount)
+    {
+        return;
+    }
+    if (0 == deadRowCount)
+    {
+        return;
+    }
+    if (deadRowCount == rowCount)
+    {
+        clear();
+        return;
+    }
+
+    // The strings of the dead rows are a prefix of the pool
+    quint32 cutStringId = qMax(m_firstStringId, qMax(m_titles.at(deadRowCount - 1), m_links.at(deadRowCount - 1)) + 1);
+    for (int keyIndex = 0; keyIndex < m_columns.count(); keyIndex++)
+    {
+        const QVector<quint32>& column = m_columns[keyIndex];
+        for (int row = 0; row < deadRowCount; row++)
+        {
+            cutStringId = qMax(cutStringId, column.at(row));
+        }
+    }
+
+    int cutStringIndex = int(cutStringId - m_firstStringId);
+    int cutBytes = (cutStringIndex < m_stringOffsets.count()) ? int(m_stringOffsets.at(cutStringIndex)) : m_stringPool.size();
+    m_stringPool.remove(0, cutBytes);
+    m_stringOffsets.remove(0, cutStringIndex);
+    for (int stringIndex = 0; stringIndex < m_stringOffsets.count(); stringIndex++)
+    {
+        m_stringOffsets[stringIndex] -= quint32(cutBytes);
+    }
+    m_firstStringId = cutStringId;
+
+    m_x.remove(0, deadRowCount);
+    m_y.remove(0, deadRowCount);
+    m_keyHashes.remove(0, deadRowCount);
+    m_seenTimes.remove(0, deadRowCount);
+    m_titles.remove(0, deadRowCount);
+    m_links.remove(0, deadRowCount);
+    for (int keyIndex = 0; keyIndex < m_columns.count(); keyIndex++)
+    {
+        m_columns[keyIndex].remove(0, deadRowCount);
+    }
+
+    QBitArray alive(rowCount - deadRowCount);
+    for (int row = deadRowCount; row < rowCount; row++)
+    {
+        alive.setBit(row - deadRowCount, m_alive.testBit(row));
+    }
+    m_alive = alive;
+    m_firstEventId += deadRowCount;
+    m_deadFrontCount = 0;
+}
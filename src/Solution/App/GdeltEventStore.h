@@ -0,0 +1,108 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef GDELTEVENTSTORE_H
+#define GDELTEVENTSTORE_H
+
+#include <QByteArray>
+#include <QBitArray>
+#include <QHash>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+// Struct of arrays holding the GDELT events of a layer.
+// Property keys are interned, coordinates are kept in contiguous arrays and
+// property values are stored as UTF-8 in one string pool.
+// The callout title and link are extracted once and stored in dedicated columns.
+// Events are identified by an ever increasing event id, the events are ordered
+// by the time they were appended.
+class GdeltEventStore
+{
+public:
+    GdeltEventStore();
+
+    qint64 append(double x, double y, const QVariantMap& properties, quint64 keyHash, qint64 seenTime,
+                  const QString& title, const QString& link);
+
+    void remove(qint64 eventId);
+
+    bool contains(qint64 eventId) const;
+
+    void clear();
+
+    int count() const;
+
+    qint64 firstEventId() const;
+    qint64 firstLiveEventId() const;
+    qint64 endEventId() const;
+
+    double x(qint64 eventId) const;
+    double y(qint64 eventId) const;
+    quint64 keyHash(qint64 eventId) const;
+    qint64 seenTime(qint64 eventId) const;
+    QString title(qint64 eventId) const;
+    QString link(qint64 eventId) const;
+
+    QVariant value(qint64 eventId, const QString& key) const;
+    QVariantMap properties(qint64 eventId) const;
+
+private:
+    int internKey(const QString& key, int type);
+    quint32 appendString(const QString& value);
+    QString string(quint32 stringId) const;
+
+    int rowOf(qint64 eventId) const;
+
+    void compactFront();
+
+    // Interned property keys and their value types
+    QStringList m_keys;
+    QHash<QString, int> m_keyIndices;
+    QVector<int> m_keyTypes;
+
+    // One entry per row
+    QVector<double> m_x;
+    QVector<double> m_y;
+    QVector<quint64> m_keyHashes;
+    QVector<qint64> m_seenTimes;
+    QBitArray m_alive;
+    QVector<quint32> m_titles;
+    QVector<quint32> m_links;
+
+    // One column per key holding string id + 1 per row, zero means missing
+    QVector<QVector<quint32>> m_columns;
+
+    // UTF-8 values, string ids stay valid when the front is compacted
+    QByteArray m_stringPool;
+    QVector<quint32> m_stringOffsets;
+    quint32 m_firstStringId = 0;
+
+    qint64 m_firstEventId = 0;
+    int m_count = 0;
+
+    // Leading rows known to be dead
+    int m_deadFrontCount = 0;
+};
+
+#endif // GDELTEVENTSTORE_H
@@ -0,0 +1,891 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "GeoJsonBinaryCache.h"
+
+#include "MultipartBuilder.h"
+#include "Part.h"
+#include "PartCollection.h"
+#include "Point.h"
+#include "Polygon.h"
+#include "PolygonBuilder.h"
+#include "Polyline.h"
+#include "PolylineBuilder.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace
+{
+const char FormatMagic[] = "GJBC";
+const quint32 FormatVersion = 1;
+
+// Magic, version, feature, key and string counts followed by the seven section positions
+const qint64 HeaderSize = 80;
+
+enum GeometryCode : quint32
+{
+    EmptyCode = 0,
+    PointCode = 1,
+    PolylineCode = 2,
+    PolygonCode = 3
+};
+
+void appendUInt32(QByteArray& buffer, quint32 value)
+{
+    value = qToLittleEndian(value);
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendUInt64(QByteArray& buffer, quint64 value)
+{
+    value = qToLittleEndian(value);
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendDouble(QByteArray& buffer, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendUInt64(buffer, bits);
+}
+
+void appendFloat(QByteArray& buffer, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendUInt32(buffer, bits);
+}
+
+// Sections are written through a small buffer, so a copy never has to fit into memory
+class SectionWriter
+{
+public:
+    SectionWriter(QIODevice* device, qint64 position) :
+        m_device(device),
+        m_position(position)
+    {
+    }
+
+    QByteArray& buffer()
+    {
+        return m_buffer;
+    }
+
+    qint64 position() const
+    {
+        return m_position + m_buffer.size();
+    }
+
+    void alignSection()
+    {
+        while (0 != position() % 8)
+        {
+            m_buffer.append('\0');
+        }
+    }
+
+    bool flush(int minBufferSize = 0)
+    {
+        if (m_buffer.size() < minBufferSize || m_buffer.isEmpty())
+        {
+            return m_valid;
+        }
+        m_valid = m_valid && m_buffer.size() == m_device->write(m_buffer);
+        m_position += m_buffer.size();
+        m_buffer.clear();
+        return m_valid;
+    }
+
+private:
+    QIODevice* m_device;
+    qint64 m_position;
+    QByteArray m_buffer;
+    bool m_valid = true;
+};
+
+const int WriteBufferSize = 1024 * 1024;
+
+quint32 zOrder(double x, double y)
+{
+    // Interleaves the bits of the location quantized to 16 bits per axis
+    quint32 column = quint32(qBound(0.0, (x + 180.0) / 360.0, 1.0) * 65535.0);
+    quint32 row = quint32(qBound(0.0, (y + 90.0) / 180.0, 1.0) * 65535.0);
+    quint32 code = 0;
+    for (int bit = 0; bit < 16; bit++)
+    {
+        code |= ((column >> bit) & 1u) << (2 * bit);
+        code |= ((row >> bit) & 1u) << (2 * bit + 1);
+    }
+    return code;
+}
+
+void appendParts(QByteArray& buffer, GeometryCode geometryCode, const ImmutablePartCollection& parts)
+{
+    appendUInt32(buffer, geometryCode);
+    appendUInt32(buffer, quint32(parts.size()));
+    for (int partIndex = 0; partIndex < parts.size(); partIndex++)
+    {
+        appendUInt32(buffer, quint32(parts.part(partIndex).pointCount()));
+    }
+    for (int partIndex = 0; partIndex < parts.size(); partIndex++)
+    {
+        ImmutablePart part = parts.part(partIndex);
+        for (int pointIndex = 0; pointIndex < part.pointCount(); pointIndex++)
+        {
+            Point point = part.point(pointIndex);
+            appendDouble(buffer, point.x());
+            appendDouble(buffer, point.y());
+        }
+    }
+}
+
+quint64 partsSize(const ImmutablePartCollection& parts)
+{
+    quint64 size = 8 + 4 * quint64(parts.size());
+    for (int partIndex = 0; partIndex < parts.size(); partIndex++)
+    {
+        size += 16 * quint64(parts.part(partIndex).pointCount());
+    }
+    return size;
+}
+
+quint64 geometrySize(const Geometry& geometry)
+{
+    // Bytes appended by appendGeometry
+    switch (geometry.geometryType())
+    {
+    case GeometryType::Point:
+        return 28;
+
+    case GeometryType::Polyline:
+        return partsSize(Polyline(geometry).parts());
+
+    case GeometryType::Polygon:
+        return partsSize(Polygon(geometry).parts());
+
+    default:
+        return 8;
+    }
+}
+
+void appendGeometry(QByteArray& buffer, const Geometry& geometry)
+{
+    // Geometry code, part count, point count of every part and the coordinates
+    switch (geometry.geometryType())
+    {
+    case GeometryType::Point:
+    {
+        Point point(geometry);
+        appendUInt32(buffer, PointCode);
+        appendUInt32(buffer, 1);
+        appendUInt32(buffer, 1);
+        appendDouble(buffer, point.x());
+        appendDouble(buffer, point.y());
+        break;
+    }
+
+    case GeometryType::Polyline:
+        appendParts(buffer, PolylineCode, Polyline(geometry).parts());
+        break;
+
+    case GeometryType::Polygon:
+        appendParts(buffer, PolygonCode, Polygon(geometry).parts());
+        break;
+
+    default:
+        appendUInt32(buffer, EmptyCode);
+        appendUInt32(buffer, 0);
+        break;
+    }
+}
+
+QString valueString(const QVariant& value)
+{
+    // Nested properties are kept as compact JSON
+    int valueType = value.userType();
+    if (QMetaType::QVariantMap == valueType || QMetaType::QVariantList == valueType)
+    {
+        return QString::fromUtf8(QJsonDocument::fromVariant(value).toJson(QJsonDocument::Compact));
+    }
+    return value.toString();
+}
+}
+
+GeoJsonBinaryCache::GeoJsonBinaryCache()
+{
+    QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    setCacheDirectory(QDir(cacheLocation).filePath("geojson"));
+}
+
+void GeoJsonBinaryCache::setCacheDirectory(const QString &cacheDirectory)
+{
+    m_cacheDirectory = cacheDirectory;
+    QDir().mkpath(m_cacheDirectory);
+}
+
+QString GeoJsonBinaryCache::cacheDirectory() const
+{
+    return m_cacheDirectory;
+}
+
+void GeoJsonBinaryCache::setMaximumSize(qint64 maximumSize)
+{
+    m_maximumSize = maximumSize;
+    evict(QString());
+}
+
+qint64 GeoJsonBinaryCache::maximumSize() const
+{
+    return m_maximumSize;
+}
+
+QString GeoJsonBinaryCache::validator(const QString &source) const
+{
+    QFile validatorFile(validatorPath(source));
+    if (!validatorFile.open(QIODevice::ReadOnly))
+    {
+        return QString();
+    }
+
+    // The validator is only known while its copy exists
+    QString sourceValidator = QString::fromUtf8(validatorFile.readAll());
+    if (!QFileInfo::exists(filePath(source, sourceValidator)))
+    {
+        return QString();
+    }
+    return sourceValidator;
+}
+
+GeoJsonBinaryCache::Source GeoJsonBinaryCache::open(const QString &source, const QString &validator) const
+{
+    QSharedPointer<QFile> cacheFile(new QFile(filePath(source, validator)));
+    if (!cacheFile->open(QIODevice::ReadOnly) || cacheFile->size() < HeaderSize)
+    {
+        return Source();
+    }
+
+    Source cachedSource;
+    cachedSource.m_data = cacheFile->map(0, cacheFile->size());
+    if (nullptr == cachedSource.m_data)
+    {
+        qDebug() << "GeoJSON cache file cannot be mapped!" << cacheFile->errorString();
+        return Source();
+    }
+    cachedSource.m_file = cacheFile;
+    cachedSource.m_size = cacheFile->size();
+
+    if (0 != std::memcmp(cachedSource.m_data, FormatMagic, 4) || FormatVersion != cachedSource.readUInt32(4))
+    {
+        qDebug() << "GeoJSON cache file has an unknown format!";
+        return Source();
+    }
+
+    quint32 featureCount = cachedSource.readUInt32(8);
+    quint32 keyCount = cachedSource.readUInt32(12);
+    quint32 stringCount = cachedSource.readUInt32(16);
+    qint64 stringOffsetsPosition = qint64(cachedSource.readUInt64(24));
+    qint64 stringDataPosition = qint64(cachedSource.readUInt64(32));
+    qint64 keyTablePosition = qint64(cachedSource.readUInt64(40));
+    qint64 bboxPosition = qint64(cachedSource.readUInt64(48));
+    qint64 recordOffsetsPosition = qint64(cachedSource.readUInt64(56));
+    qint64 recordDataPosition = qint64(cachedSource.readUInt64(64));
+    qint64 columnsPosition = qint64(cachedSource.readUInt64(72));
+
+    // Truncated or corrupted files are rejected before anything is read from the sections
+    bool validLayout = HeaderSize <= stringOffsetsPosition
+            && stringOffsetsPosition + 4 * (qint64(stringCount) + 1) <= stringDataPosition
+            && stringDataPosition <= keyTablePosition
+            && keyTablePosition + 8 * qint64(keyCount) <= bboxPosition
+            && bboxPosition + 16 * qint64(featureCount) <= recordOffsetsPosition
+            && recordOffsetsPosition + 8 * (qint64(featureCount) + 1) <= recordDataPosition
+            && recordDataPosition <= columnsPosition
+            && columnsPosition + 4 * qint64(keyCount) * featureCount <= cachedSource.m_size;
+    if (validLayout)
+    {
+        validLayout = stringDataPosition + cachedSource.readUInt32(stringOffsetsPosition + 4 * qint64(stringCount)) <= keyTablePosition
+                && recordDataPosition + qint64(cachedSource.readUInt64(recordOffsetsPosition + 8 * qint64(featureCount))) <= columnsPosition;
+    }
+    if (!validLayout)
+    {
+        qDebug() << "GeoJSON cache file is corrupted!";
+        return Source();
+    }
+
+    cachedSource.m_featureCount = int(featureCount);
+    cachedSource.m_stringCount = stringCount;
+    cachedSource.m_stringOffsetsPosition = stringOffsetsPosition;
+    cachedSource.m_stringDataPosition = stringDataPosition;
+    cachedSource.m_bboxPosition = bboxPosition;
+    cachedSource.m_recordOffsetsPosition = recordOffsetsPosition;
+    cachedSource.m_recordDataPosition = recordDataPosition;
+    cachedSource.m_columnsPosition = columnsPosition;
+    for (quint32 keyIndex = 0; keyIndex < keyCount; keyIndex++)
+    {
+        quint32 keyStringId = cachedSource.readUInt32(keyTablePosition + 8 * qint64(keyIndex));
+        QString key;
+        if (!cachedSource.readString(keyStringId, key))
+        {
+            qDebug() << "GeoJSON cache file is corrupted!";
+            return Source();
+        }
+        cachedSource.m_keys.append(key);
+        cachedSource.m_keyTypes.append(int(cachedSource.readUInt32(keyTablePosition + 8 * qint64(keyIndex) + 4)));
+    }
+
+    return cachedSource;
+}
+
+bool GeoJsonBinaryCache::write(const QString &source, const QString &validator, const ParsedFeatureList &features) const
+{
+    // Nearby features are stored next to each other
+    QVector<QPair<quint32, int>> featureOrder;
+    QVector<QRectF> featureExtents;
+    featureOrder.reserve(features.count());
+    featureExtents.reserve(features.count());
+    for (int featureIndex = 0; featureIndex < features.count(); featureIndex++)
+    {
+        Envelope featureExtent = features.at(featureIndex).geometry.extent();
+        QRectF extent;
+        if (!featureExtent.isEmpty())
+        {
+            extent = QRectF(QPointF(featureExtent.xMin(), featureExtent.yMin()), QPointF(featureExtent.xMax(), featureExtent.yMax()));
+        }
+        featureExtents.append(extent);
+        featureOrder.append(qMakePair(zOrder(extent.center().x(), extent.center().y()), featureIndex));
+    }
+    std::stable_sort(featureOrder.begin(), featureOrder.end(), [](const QPair<quint32, int>& left, const QPair<quint32, int>& right)
+    {
+        return left.first < right.first;
+    });
+
+    // Attribute keys and values are interned into one string pool
+    QHash<QString, quint32> stringIds;
+    QByteArray stringData;
+    QVector<quint32> stringOffsets;
+    auto internString = [&stringIds, &stringData, &stringOffsets](const QString& value)
+    {
+        auto stringIterator = stringIds.constFind(value);
+        if (stringIterator != stringIds.constEnd())
+        {
+            return stringIterator.value();
+        }
+        quint32 stringId = quint32(stringOffsets.count());
+        stringOffsets.append(quint32(stringData.size()));
+        stringData.append(value.toUtf8());
+        stringIds.insert(value, stringId);
+        return stringId;
+    };
+
+    QStringList keys;
+    QHash<QString, int> keyIndices;
+    QVector<int> keyTypes;
+    QVector<QVector<quint32>> columns;
+
+    // Only the record offsets are computed up front, the records are encoded while they are written
+    QVector<quint64> recordOffsets;
+    quint64 recordDataSize = 0;
+    int featureCount = featureOrder.count();
+    recordOffsets.reserve(featureCount + 1);
+    for (int row = 0; row < featureCount; row++)
+    {
+        const ParsedFeature& feature = features.at(featureOrder.at(row).second);
+        recordOffsets.append(recordDataSize);
+        recordDataSize += 4 + geometrySize(feature.geometry);
+        foreach (const Geometry& level, feature.levels)
+        {
+            recordDataSize += geometrySize(level);
+        }
+
+        for (auto attributeIterator = feature.attributes.constBegin(); attributeIterator != feature.attributes.constEnd(); ++attributeIterator)
+        {
+            const QVariant& attributeValue = attributeIterator.value();
+            if (!attributeValue.isValid() || attributeValue.isNull())
+            {
+                continue;
+            }
+
+            int keyIndex = keyIndices.value(attributeIterator.key(), -1);
+            if (-1 == keyIndex)
+            {
+                keyIndex = keys.count();
+                keys.append(attributeIterator.key());
+                keyIndices.insert(attributeIterator.key(), keyIndex);
+                keyTypes.append(attributeValue.userType());
+                columns.append(QVector<quint32>(featureCount, 0));
+            }
+            columns[keyIndex][row] = internString(valueString(attributeValue)) + 1;
+        }
+    }
+    recordOffsets.append(recordDataSize);
+
+    QVector<quint32> keyStringIds;
+    foreach (const QString& key, keys)
+    {
+        keyStringIds.append(internString(key));
+    }
+    quint32 stringCount = quint32(stringOffsets.count());
+    stringOffsets.append(quint32(stringData.size()));
+
+    // Readers never see a partially written copy
+    QSaveFile cacheFile(filePath(source, validator));
+    if (!cacheFile.open(QIODevice::WriteOnly))
+    {
+        qDebug() << cacheFile.errorString();
+        return false;
+    }
+
+    // Header followed by the 8 byte aligned sections, the header is written once the positions are known
+    SectionWriter writer(&cacheFile, 0);
+    writer.buffer().fill('\0', int(HeaderSize));
+    QVector<quint64> sectionPositions;
+    writer.alignSection();
+    sectionPositions.append(quint64(writer.position()));
+    foreach (quint32 stringOffset, stringOffsets)
+    {
+        appendUInt32(writer.buffer(), stringOffset);
+        writer.flush(WriteBufferSize);
+    }
+    writer.alignSection();
+    sectionPositions.append(quint64(writer.position()));
+    writer.flush();
+    writer.buffer() = stringData;
+    writer.alignSection();
+    sectionPositions.append(quint64(writer.position()));
+    writer.flush();
+    for (int keyIndex = 0; keyIndex < keys.count(); keyIndex++)
+    {
+        appendUInt32(writer.buffer(), keyStringIds.at(keyIndex));
+        appendUInt32(writer.buffer(), quint32(keyTypes.at(keyIndex)));
+    }
+    writer.alignSection();
+    sectionPositions.append(quint64(writer.position()));
+    for (int row = 0; row < featureCount; row++)
+    {
+        // The packed extents are rounded outwards
+        const QRectF& extent = featureExtents.at(featureOrder.at(row).second);
+        appendFloat(writer.buffer(), std::nextafter(float(extent.left()), -HUGE_VALF));
+        appendFloat(writer.buffer(), std::nextafter(float(extent.top()), -HUGE_VALF));
+        appendFloat(writer.buffer(), std::nextafter(float(extent.right()), HUGE_VALF));
+        appendFloat(writer.buffer(), std::nextafter(float(extent.bottom()), HUGE_VALF));
+        writer.flush(WriteBufferSize);
+    }
+    writer.alignSection();
+    sectionPositions.append(quint64(writer.position()));
+    foreach (quint64 recordOffset, recordOffsets)
+    {
+        appendUInt64(writer.buffer(), recordOffset);
+        writer.flush(WriteBufferSize);
+    }
+    writer.alignSection();
+    sectionPositions.append(quint64(writer.position()));
+    for (int row = 0; row < featureCount; row++)
+    {
+        const ParsedFeature& feature = features.at(featureOrder.at(row).second);
+        appendUInt32(writer.buffer(), quint32(1 + feature.levels.count()));
+        appendGeometry(writer.buffer(), feature.geometry);
+        foreach (const Geometry& level, feature.levels)
+        {
+            appendGeometry(writer.buffer(), level);
+        }
+        writer.flush(WriteBufferSize);
+    }
+    writer.alignSection();
+    sectionPositions.append(quint64(writer.position()));
+    foreach (const QVector<quint32>& column, columns)
+    {
+        foreach (quint32 storedId, column)
+        {
+            appendUInt32(writer.buffer(), storedId);
+        }
+        writer.flush(WriteBufferSize);
+    }
+
+    QByteArray header;
+    header.append(FormatMagic, 4);
+    appendUInt32(header, FormatVersion);
+    appendUInt32(header, quint32(featureCount));
+    appendUInt32(header, quint32(keys.count()));
+    appendUInt32(header, stringCount);
+    appendUInt32(header, 0);
+    foreach (quint64 sectionPosition, sectionPositions)
+    {
+        appendUInt64(header, sectionPosition);
+    }
+    if (!writer.flush() || !cacheFile.seek(0) || header.size() != cacheFile.write(header))
+    {
+        qDebug() << cacheFile.errorString();
+        cacheFile.cancelWriting();
+        return false;
+    }
+    if (!cacheFile.commit())
+    {
+        qDebug() << cacheFile.errorString();
+        return false;
+    }
+
+    QString previousValidator = this->validator(source);
+    QSaveFile validatorFile(validatorPath(source));
+    if (!validatorFile.open(QIODevice::WriteOnly))
+    {
+        qDebug() << validatorFile.errorString();
+        return false;
+    }
+    validatorFile.write(validator.toUtf8());
+    if (!validatorFile.commit())
+    {
+        qDebug() << validatorFile.errorString();
+        return false;
+    }
+
+    // Copies of outdated validators are never read again
+    if (!previousValidator.isEmpty() && previousValidator != validator)
+    {
+        QFile::remove(filePath(source, previousValidator));
+    }
+
+    evict(filePath(source, validator));
+    return true;
+}
+
+void GeoJsonBinaryCache::remove(const QString &source) const
+{
+    QString sourceValidator = validator(source);
+    if (!sourceValidator.isEmpty())
+    {
+        QFile::remove(filePath(source, sourceValidator));
+    }
+    QFile::remove(validatorPath(source));
+}
+
+QString GeoJsonBinaryCache::fileValidator(const QString &filePath)
+{
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists())
+    {
+        return QString();
+    }
+    return QString("file:%1:%2").arg(fileInfo.size()).arg(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+
+QString GeoJsonBinaryCache::filePath(const QString &source, const QString &validator) const
+{
+    QByteArray keyData = (source + "|" + validator).toUtf8();
+    QString key = QCryptographicHash::hash(keyData, QCryptographicHash::Sha1).toHex();
+    return QDir(m_cacheDirectory).filePath(key + ".gjb");
+}
+
+QString GeoJsonBinaryCache::validatorPath(const QString &source) const
+{
+    QString key = QCryptographicHash::hash(source.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(m_cacheDirectory).filePath(key + ".validator");
+}
+
+void GeoJsonBinaryCache::evict(const QString &keptFilePath) const
+{
+    // Copies are shared by the writers of all threads, so the directory is the only index
+    QFileInfoList cacheFileInfos = QDir(m_cacheDirectory).entryInfoList(QStringList() << "*.gjb", QDir::Files);
+    qint64 currentSize = 0;
+    foreach (const QFileInfo& cacheFileInfo, cacheFileInfos)
+    {
+        currentSize += cacheFileInfo.size();
+    }
+    if (currentSize <= m_maximumSize)
+    {
+        return;
+    }
+
+    // Least recently read copies are removed first, the copy just written is kept
+    std::sort(cacheFileInfos.begin(), cacheFileInfos.end(), [](const QFileInfo& left, const QFileInfo& right)
+    {
+        return left.lastRead() < right.lastRead();
+    });
+    foreach (const QFileInfo& cacheFileInfo, cacheFileInfos)
+    {
+        if (currentSize <= m_maximumSize)
+        {
+            break;
+        }
+        if (cacheFileInfo.absoluteFilePath() == QFileInfo(keptFilePath).absoluteFilePath())
+        {
+            continue;
+        }
+        if (QFile::remove(cacheFileInfo.absoluteFilePath()))
+        {
+            currentSize -= cacheFileInfo.size();
+        }
+    }
+}
+
+bool GeoJsonBinaryCache::Source::isValid() const
+{
+    return nullptr != m_data;
+}
+
+int GeoJsonBinaryCache::Source::featureCount() const
+{
+    return m_featureCount;
+}
+
+QRectF GeoJsonBinaryCache::Source::extent(int begin, int end) const
+{
+    QRectF rangeExtent;
+    for (int row = begin; row < end; row++)
+    {
+        qint64 bboxPosition = m_bboxPosition + 16 * qint64(row);
+        QRectF featureExtent(QPointF(double(readFloat(bboxPosition)), double(readFloat(bboxPosition + 4))),
+                             QPointF(double(readFloat(bboxPosition + 8)), double(readFloat(bboxPosition + 12))));
+        rangeExtent = rangeExtent.isNull() ? featureExtent : rangeExtent.united(featureExtent);
+    }
+    return rangeExtent;
+}
+
+ParsedFeatureList GeoJsonBinaryCache::Source::readFeatures(int begin, int end, bool* valid) const
+{
+    ParsedFeatureList features;
+    if (nullptr != valid)
+    {
+        *valid = true;
+    }
+    auto fail = [&features, valid]()
+    {
+        qDebug() << "GeoJSON cache file is corrupted!";
+        features.clear();
+        if (nullptr != valid)
+        {
+            *valid = false;
+        }
+        return features;
+    };
+
+    end = qMin(end, m_featureCount);
+    qint64 recordDataSize = m_columnsPosition - m_recordDataPosition;
+    for (int row = qMax(0, begin); row < end; row++)
+    {
+        // A record must lie within the record data and before the next one
+        quint64 recordOffset = readUInt64(m_recordOffsetsPosition + 8 * qint64(row));
+        quint64 nextRecordOffset = readUInt64(m_recordOffsetsPosition + 8 * (qint64(row) + 1));
+        if (nextRecordOffset < recordOffset || quint64(recordDataSize) < nextRecordOffset || nextRecordOffset - recordOffset < 4)
+        {
+            return fail();
+        }
+
+        ParsedFeature feature;
+        qint64 position = m_recordDataPosition + qint64(recordOffset);
+        qint64 recordEnd = m_recordDataPosition + qint64(nextRecordOffset);
+        quint32 geometryCount = readUInt32(position);
+        position += 4;
+        for (quint32 geometryIndex = 0; geometryIndex < geometryCount; geometryIndex++)
+        {
+            Geometry geometry;
+            if (!readGeometry(position, recordEnd, geometry))
+            {
+                return fail();
+            }
+            if (0 == geometryIndex)
+            {
+                feature.geometry = geometry;
+            }
+            else
+            {
+                feature.levels.append(geometry);
+            }
+        }
+
+        for (int keyIndex = 0; keyIndex < m_keys.count(); keyIndex++)
+        {
+            quint32 storedId = readUInt32(m_columnsPosition + 4 * (qint64(keyIndex) * m_featureCount + row));
+            if (0 == storedId)
+            {
+                continue;
+            }
+
+            QString stringValue;
+            if (!readString(storedId - 1, stringValue))
+            {
+                return fail();
+            }
+            QVariant attributeValue(stringValue);
+            int valueType = m_keyTypes.at(keyIndex);
+            if (QMetaType::QVariantMap == valueType || QMetaType::QVariantList == valueType)
+            {
+                attributeValue = QJsonDocument::fromJson(stringValue.toUtf8()).toVariant();
+            }
+            else if (QMetaType::QString != valueType)
+            {
+                // Values not matching the type of their key stay strings
+                QVariant convertedValue = attributeValue;
+                if (convertedValue.convert(valueType))
+                {
+                    attributeValue = convertedValue;
+                }
+            }
+            feature.attributes.insert(m_keys.at(keyIndex), attributeValue);
+        }
+
+        features.append(feature);
+    }
+    return features;
+}
+
+quint32 GeoJsonBinaryCache::Source::readUInt32(qint64 position) const
+{
+    return qFromLittleEndian<quint32>(m_data + position);
+}
+
+quint64 GeoJsonBinaryCache::Source::readUInt64(qint64 position) const
+{
+    return qFromLittleEndian<quint64>(m_data + position);
+}
+
+double GeoJsonBinaryCache::Source::readDouble(qint64 position) const
+{
+    quint64 bits = readUInt64(position);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+float GeoJsonBinaryCache::Source::readFloat(qint64 position) const
+{
+    quint32 bits = readUInt32(position);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool GeoJsonBinaryCache::Source::readString(quint32 stringId, QString &value) const
+{
+    if (m_stringCount <= stringId)
+    {
+        return false;
+    }
+
+    // The offsets are only known to be inside the string data when they are ascending
+    quint32 begin = readUInt32(m_stringOffsetsPosition + 4 * qint64(stringId));
+    quint32 end = readUInt32(m_stringOffsetsPosition + 4 * (qint64(stringId) + 1));
+    quint32 stringDataSize = readUInt32(m_stringOffsetsPosition + 4 * qint64(m_stringCount));
+    if (end < begin || stringDataSize < end)
+    {
+        return false;
+    }
+
+    value = QString::fromUtf8(reinterpret_cast<const char*>(m_data + m_stringDataPosition + begin), int(end - begin));
+    return true;
+}
+
+bool GeoJsonBinaryCache::Source::readGeometry(qint64 &position, qint64 endPosition, Geometry &geometry) const
+{
+    if (endPosition - position < 8)
+    {
+        return false;
+    }
+
+    quint32 geometryCode = readUInt32(position);
+    quint32 partCount = readUInt32(position + 4);
+    position += 8;
+    if ((endPosition - position) / 4 < qint64(partCount))
+    {
+        return false;
+    }
+
+    // The coordinates of all parts must fit into the record
+    QVector<quint32> pointCounts;
+    qint64 totalPointCount = 0;
+    for (quint32 partIndex = 0; partIndex < partCount; partIndex++, position += 4)
+    {
+        pointCounts.append(readUInt32(position));
+        totalPointCount += pointCounts.last();
+    }
+    if ((endPosition - position) / 16 < totalPointCount)
+    {
+        return false;
+    }
+
+    auto addParts = [this, &position, &pointCounts](MultipartBuilder& builder)
+    {
+        for (int partIndex = 0; partIndex < pointCounts.count(); partIndex++)
+        {
+            // The builder appends the points to its last part
+            if (0 < partIndex)
+            {
+                builder.parts()->addPart(new Part(SpatialReference::wgs84(), &builder));
+            }
+            for (quint32 pointIndex = 0; pointIndex < pointCounts.at(partIndex); pointIndex++, position += 16)
+            {
+                builder.addPoint(readDouble(position), readDouble(position + 8));
+            }
+        }
+    };
+
+    switch (geometryCode)
+    {
+    case EmptyCode:
+        geometry = Geometry();
+        return 0 == partCount;
+
+    case PointCode:
+    {
+        if (1 != totalPointCount)
+        {
+            return false;
+        }
+        geometry = Point(readDouble(position), readDouble(position + 8), SpatialReference::wgs84());
+        position += 16;
+        return true;
+    }
+
+    case PolylineCode:
+    {
+        PolylineBuilder polylineBuilder(SpatialReference::wgs84());
+        addParts(polylineBuilder);
+        geometry = polylineBuilder.toPolyline();
+        return true;
+    }
+
+    case PolygonCode:
+    {
+        PolygonBuilder polygonBuilder(SpatialReference::wgs84());
+        addParts(polygonBuilder);
+        geometry = polygonBuilder.toPolygon();
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,113 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef GEOJSONBINARYCACHE_H
+#define GEOJSONBINARYCACHE_H
+
+#include "ParsedFeature.h"
+
+#include <QRectF>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+class QFile;
+
+// Binary copies of the loaded GeoJSON sources for a fast reload.
+// A copy is keyed by the source and its validator, which is the ETag or Last-Modified
+// header of a download or the size and modification time of a local file.
+// The features are ordered by the Z-order of their extent centers. A copy holds the
+// geometries and their generalized levels in one buffer addressed by offsets, a packed
+// bbox index and one column of interned UTF-8 strings per attribute key.
+// Every offset and count read from a copy is checked, reading a corrupted copy fails.
+// The least recently read copies are removed when the copies exceed the maximum size.
+class GeoJsonBinaryCache
+{
+public:
+    // Memory mapped copy of a source, the features can be read from any thread
+    class Source
+    {
+    public:
+        bool isValid() const;
+
+        int featureCount() const;
+
+        QRectF extent(int begin, int end) const;
+
+        ParsedFeatureList readFeatures(int begin, int end, bool* valid = nullptr) const;
+
+    private:
+        friend class GeoJsonBinaryCache;
+
+        quint32 readUInt32(qint64 position) const;
+        quint64 readUInt64(qint64 position) const;
+        double readDouble(qint64 position) const;
+        float readFloat(qint64 position) const;
+        bool readString(quint32 stringId, QString& value) const;
+
+        bool readGeometry(qint64& position, qint64 endPosition, Esri::ArcGISRuntime::Geometry& geometry) const;
+
+        QSharedPointer<QFile> m_file;
+        const uchar* m_data = nullptr;
+        qint64 m_size = 0;
+        int m_featureCount = 0;
+        QStringList m_keys;
+        QVector<int> m_keyTypes;
+        quint32 m_stringCount = 0;
+        qint64 m_stringOffsetsPosition = 0;
+        qint64 m_stringDataPosition = 0;
+        qint64 m_bboxPosition = 0;
+        qint64 m_recordOffsetsPosition = 0;
+        qint64 m_recordDataPosition = 0;
+        qint64 m_columnsPosition = 0;
+    };
+
+    GeoJsonBinaryCache();
+
+    void setCacheDirectory(const QString& cacheDirectory);
+    QString cacheDirectory() const;
+
+    void setMaximumSize(qint64 maximumSize);
+    qint64 maximumSize() const;
+
+    QString validator(const QString& source) const;
+
+    Source open(const QString& source, const QString& validator) const;
+
+    bool write(const QString& source, const QString& validator, const ParsedFeatureList& features) const;
+
+    void remove(const QString& source) const;
+
+    static QString fileValidator(const QString& filePath);
+
+private:
+    QString filePath(const QString& source, const QString& validator) const;
+    QString validatorPath(const QString& source) const;
+
+    void evict(const QString& keptFilePath) const;
+
+    QString m_cacheDirectory;
+    qint64 m_maximumSize = 1024 * 1024 * 1024;
+};
+
+#endif // GEOJSONBINARYCACHE_H
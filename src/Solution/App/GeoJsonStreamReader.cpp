@@ -0,0 +1,229 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "GeoJsonStreamReader.h"
+
+namespace
+{
+// Starts every record of a GeoJSON text sequence
+const char RecordSeparator = 0x1e;
+}
+
+GeoJsonStreamReader::GeoJsonStreamReader()
+{
+}
+
+void GeoJsonStreamReader::addData(const char *data, int size)
+{
+    if (m_atEnd)
+    {
+        return;
+    }
+
+    if (m_buffer.isEmpty())
+    {
+        // Scanned in place, only the incomplete tail is copied
+        scan(data, 0, size);
+        keepTail(data, size);
+        return;
+    }
+
+    int scanPosition = m_buffer.size();
+    m_buffer.append(data, size);
+    scan(m_buffer.constData(), scanPosition, m_buffer.size());
+    QByteArray buffer = m_buffer;
+    m_buffer.clear();
+    keepTail(buffer.constData(), buffer.size());
+}
+
+void GeoJsonStreamReader::addData(const QByteArray &data)
+{
+    addData(data.constData(), data.size());
+}
+
+void GeoJsonStreamReader::scan(const char *bytes, int scanPosition, int bufferSize)
+{
+    for (int position = scanPosition; position < bufferSize && !m_atEnd; position++)
+    {
+        char nextByte = bytes[position];
+        if (RecordSeparator == nextByte)
+        {
+            // A text sequence drops the rest of a truncated record
+            m_format = Format::FeatureSequence;
+            m_depth = 0;
+            m_inString = false;
+            m_escaped = false;
+            m_featureStart = -1;
+            continue;
+        }
+
+        if (m_inString)
+        {
+            if (m_escaped)
+            {
+                m_escaped = false;
+            }
+            else if ('\\' == nextByte)
+            {
+                m_escaped = true;
+            }
+            else if ('"' == nextByte)
+            {
+                m_inString = false;
+                if (1 == m_depth)
+                {
+                    // Members of the root object
+                    m_lastKey = QByteArray(bytes + m_stringStart, position - m_stringStart);
+                }
+            }
+            continue;
+        }
+
+        switch (nextByte)
+        {
+        case '"':
+            m_inString = true;
+            m_stringStart = position + 1;
+            break;
+
+        case '{':
+        case '[':
+            if (m_inFeatures && 2 == m_depth && '{' == nextByte)
+            {
+                m_featureStart = position;
+            }
+            else if (0 == m_depth && '{' == nextByte && Format::FeatureCollection != m_format)
+            {
+                // Root objects are kept until they turn out to be a FeatureCollection
+                m_featureStart = position;
+            }
+            else if (1 == m_depth && '[' == nextByte && "features" == m_lastKey && Format::FeatureSequence != m_format)
+            {
+                m_format = Format::FeatureCollection;
+                m_featureStart = -1;
+                m_inFeatures = true;
+            }
+            m_depth++;
+            break;
+
+        case '}':
+        case ']':
+            m_depth--;
+            if (m_inFeatures && 2 == m_depth && -1 != m_featureStart)
+            {
+                appendFeature(bytes, position + 1);
+            }
+            else if (m_inFeatures && 1 == m_depth)
+            {
+                m_inFeatures = false;
+            }
+            else if (m_depth <= 0 && Format::FeatureCollection != m_format)
+            {
+                // A root object without features array is a feature of a sequence
+                m_depth = 0;
+                m_format = Format::FeatureSequence;
+                if (-1 != m_featureStart)
+                {
+                    appendFeature(bytes, position + 1);
+                }
+            }
+            else if (m_depth <= 0)
+            {
+                m_atEnd = true;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+void GeoJsonStreamReader::appendFeature(const char *bytes, int end)
+{
+    if (0 < m_pendingFeatureCount)
+    {
+        m_pendingFeatures.append(',');
+    }
+    m_pendingFeatures.append(bytes + m_featureStart, end - m_featureStart);
+    m_pendingFeatureCount++;
+    m_featureCount++;
+    m_featureStart = -1;
+}
+
+int GeoJsonStreamReader::pendingFeatureCount() const
+{
+    return m_pendingFeatureCount;
+}
+
+QByteArray GeoJsonStreamReader::takeFeatures()
+{
+    QByteArray featuresArray;
+    featuresArray.reserve(m_pendingFeatures.size() + 2);
+    featuresArray.append('[');
+    featuresArray.append(m_pendingFeatures);
+    featuresArray.append(']');
+    m_pendingFeatures.clear();
+    m_pendingFeatureCount = 0;
+    return featuresArray;
+}
+
+int GeoJsonStreamReader::featureCount() const
+{
+    return m_featureCount;
+}
+
+bool GeoJsonStreamReader::atEnd() const
+{
+    // Sequences may end after any complete feature
+    return m_atEnd || (Format::FeatureSequence == m_format && 0 == m_depth && !m_inString);
+}
+
+bool GeoJsonStreamReader::isSequence() const
+{
+    return Format::FeatureSequence == m_format;
+}
+
+void GeoJsonStreamReader::keepTail(const char *bytes, int size)
+{
+    // Only the feature being read and a member name of the root object are kept
+    int keepPosition = size;
+    if (-1 != m_featureStart)
+    {
+        keepPosition = m_featureStart;
+    }
+    if (m_inString && 1 == m_depth)
+    {
+        keepPosition = qMin(keepPosition, m_stringStart);
+    }
+
+    m_buffer = QByteArray(bytes + keepPosition, size - keepPosition);
+    if (-1 != m_featureStart)
+    {
+        m_featureStart -= keepPosition;
+    }
+    if (m_inString)
+    {
+        m_stringStart -= keepPosition;
+    }
+}
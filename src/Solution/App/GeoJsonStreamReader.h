@@ -0,0 +1,83 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef GEOJSONSTREAMREADER_H
+#define GEOJSONSTREAMREADER_H
+
+#include <QByteArray>
+
+// Incremental reader of a GeoJSON FeatureCollection or of a sequence of features,
+// being either newline delimited or a GeoJSON text sequence (RFC 8142).
+// The format is detected from the first root object: it is a FeatureCollection as soon
+// as a "features" array shows up, otherwise the root objects are the features.
+// The UTF-8 bytes are scanned in place as they arrive, only the JSON text of
+// the feature being read is buffered. Complete features are collected until
+// they are taken as one JSON array.
+class GeoJsonStreamReader
+{
+public:
+    GeoJsonStreamReader();
+
+    void addData(const char* data, int size);
+    void addData(const QByteArray& data);
+
+    int pendingFeatureCount() const;
+    QByteArray takeFeatures();
+
+    int featureCount() const;
+
+    bool atEnd() const;
+
+    bool isSequence() const;
+
+private:
+    enum class Format
+    {
+        Unknown,
+        FeatureCollection,
+        FeatureSequence
+    };
+
+    void appendFeature(const char* bytes, int end);
+
+    void scan(const char* bytes, int scanPosition, int bufferSize);
+    void keepTail(const char* bytes, int size);
+
+    QByteArray m_buffer;
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escaped = false;
+    int m_stringStart = -1;
+    QByteArray m_lastKey;
+    bool m_inFeatures = false;
+    int m_featureStart = -1;
+    bool m_atEnd = false;
+    Format m_format = Format::Unknown;
+
+    // Complete features separated by commas
+    QByteArray m_pendingFeatures;
+    int m_pendingFeatureCount = 0;
+    int m_featureCount = 0;
+};
+
+#endif // GEOJSONSTREAMREADER_H
@@ -0,0 +1,407 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "GeoJsonTileIndex.h"
+
+#include "GeometryEngine.h"
+#include "GeometryPyramid.h"
+
+#include <QSet>
+#include <QtMath>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace
+{
+// Features are binned by the 64 x 64 tiles of zoom level 6
+const int BinZoom = 6;
+const int MaxBinsPerFeature = 16;
+const int MaxZoom = 18;
+const int TileSizeInPixels = 256;
+const int MaxCoveringTileCount = 256;
+const double MaxLatitude = 85.0511287798;
+
+// Number of tile features being cached
+const int MaxCachedFeatureCount = 250000;
+}
+
+GeoJsonTileIndex::GeoJsonTileIndex() :
+    m_tiles(MaxCachedFeatureCount)
+{
+}
+
+QVector<int> GeoJsonTileIndex::insert(const ParsedFeatureList &features)
+{
+    QVector<int> featureIds;
+    QSet<quint32> changedBins;
+    foreach (const ParsedFeature& feature, features)
+    {
+        Envelope featureEnvelope = feature.geometry.extent();
+        if (featureEnvelope.isEmpty() && GeometryType::Point != feature.geometry.geometryType())
+        {
+            continue;
+        }
+
+        SourceFeature sourceFeature;
+        sourceFeature.feature = feature;
+        sourceFeature.extent = QRectF(QPointF(featureEnvelope.xMin(), featureEnvelope.yMin()),
+                                      QPointF(featureEnvelope.xMax(), featureEnvelope.yMax()));
+        int featureId = m_features.count();
+        m_features.append(sourceFeature);
+        featureIds.append(featureId);
+        m_count++;
+
+        int firstColumn = tileColumn(sourceFeature.extent.left(), BinZoom);
+        int lastColumn = tileColumn(sourceFeature.extent.right(), BinZoom);
+        int firstRow = tileRow(sourceFeature.extent.bottom(), BinZoom);
+        int lastRow = tileRow(sourceFeature.extent.top(), BinZoom);
+        if (MaxBinsPerFeature < (lastColumn - firstColumn + 1) * (lastRow - firstRow + 1))
+        {
+            // Large features are candidates of every tile
+            m_largeFeatureIds.append(featureId);
+            addBins(sourceFeature.extent, changedBins);
+            continue;
+        }
+
+        for (int column = firstColumn; column <= lastColumn; column++)
+        {
+            for (int row = firstRow; row <= lastRow; row++)
+            {
+                quint32 bin = quint32(column << BinZoom) | quint32(row);
+                m_bins[bin].append(featureId);
+                changedBins.insert(bin);
+            }
+        }
+    }
+
+    invalidateTiles(changedBins);
+    return featureIds;
+}
+
+bool GeoJsonTileIndex::features(const QVector<int> &featureIds, ParsedFeatureList &features) const
+{
+    // Fails when one of the features was removed in the meantime
+    features.reserve(features.count() + featureIds.count());
+    foreach (int featureId, featureIds)
+    {
+        if (featureId < 0 || m_features.count() <= featureId || m_features.at(featureId).removed)
+        {
+            return false;
+        }
+        features.append(m_features.at(featureId).feature);
+    }
+    return true;
+}
+
+void GeoJsonTileIndex::remove(const QList<int> &featureIds)
+{
+    QSet<quint32> changedBins;
+    foreach (int featureId, featureIds)
+    {
+        if (0 <= featureId && featureId < m_features.count() && !m_features[featureId].removed)
+        {
+            // Only marked, the bins are rebuilt when the index is cleared
+            m_features[featureId].removed = true;
+            m_features[featureId].feature = ParsedFeature();
+            addBins(m_features[featureId].extent, changedBins);
+            m_count--;
+        }
+    }
+
+    invalidateTiles(changedBins);
+}
+
+void GeoJsonTileIndex::remove(GeometryType geometryType)
+{
+    QList<int> featureIds;
+    for (int featureId = 0; featureId < m_features.count(); featureId++)
+    {
+        const SourceFeature& sourceFeature = m_features.at(featureId);
+        if (!sourceFeature.removed && geometryType == sourceFeature.feature.geometry.geometryType())
+        {
+            featureIds.append(featureId);
+        }
+    }
+    remove(featureIds);
+}
+
+void GeoJsonTileIndex::clear()
+{
+    m_features.clear();
+    m_bins.clear();
+    m_largeFeatureIds.clear();
+    m_tiles.clear();
+    m_count = 0;
+    m_changedBins.clear();
+    m_allChanged = true;
+}
+
+int GeoJsonTileIndex::count() const
+{
+    return m_count;
+}
+
+int GeoJsonTileIndex::zoomForResolution(double degreesPerPixel)
+{
+    if (degreesPerPixel <= 0)
+    {
+        return MaxZoom;
+    }
+
+    // Tiles are shown with about their native size
+    double zoom = std::log2(360.0 / (TileSizeInPixels * degreesPerPixel));
+    return qBound(0, qRound(zoom), MaxZoom);
+}
+
+QList<quint64> GeoJsonTileIndex::coveringTiles(const QRectF &extent, int zoom)
+{
+    QList<quint64> tileKeys;
+    if (extent.isEmpty())
+    {
+        return tileKeys;
+    }
+
+    int firstColumn = tileColumn(extent.left(), zoom);
+    int lastColumn = tileColumn(extent.right(), zoom);
+    int firstRow = tileRow(extent.bottom(), zoom);
+    int lastRow = tileRow(extent.top(), zoom);
+    while (0 < zoom && MaxCoveringTileCount < (lastColumn - firstColumn + 1) * (lastRow - firstRow + 1))
+    {
+        // Too many tiles, the parent tiles are used instead
+        zoom--;
+        firstColumn >>= 1;
+        lastColumn >>= 1;
+        firstRow >>= 1;
+        lastRow >>= 1;
+    }
+
+    for (int column = firstColumn; column <= lastColumn; column++)
+    {
+        for (int row = firstRow; row <= lastRow; row++)
+        {
+            tileKeys.append(tileKey(zoom, column, row));
+        }
+    }
+    return tileKeys;
+}
+
+GeoJsonTileIndex::Tile GeoJsonTileIndex::tile(quint64 tileKey)
+{
+    Tile* cachedTile = m_tiles.object(tileKey);
+    if (nullptr != cachedTile)
+    {
+        return *cachedTile;
+    }
+
+    int zoom = int(tileKey >> 58);
+    int column = int((tileKey >> 29) & 0x1fffffff);
+    int row = int(tileKey & 0x1fffffff);
+    QRectF tileExtent = tileBounds(zoom, column, row);
+    Envelope tileEnvelope(tileExtent.left(), tileExtent.top(), tileExtent.right(), tileExtent.bottom(), SpatialReference::wgs84());
+
+    // Candidates are the features of the bins covered by the tile
+    QVector<int> candidateIds = m_largeFeatureIds;
+    if (BinZoom <= zoom)
+    {
+        int shift = zoom - BinZoom;
+        candidateIds += m_bins.value(quint32((column >> shift) << BinZoom) | quint32(row >> shift));
+    }
+    else
+    {
+        int shift = BinZoom - zoom;
+        QSet<int> binnedIds;
+        for (int binColumn = column << shift; binColumn < (column + 1) << shift; binColumn++)
+        {
+            for (int binRow = row << shift; binRow < (row + 1) << shift; binRow++)
+            {
+                auto binIterator = m_bins.constFind(quint32(binColumn << BinZoom) | quint32(binRow));
+                if (binIterator != m_bins.constEnd())
+                {
+                    foreach (int featureId, binIterator.value())
+                    {
+                        binnedIds.insert(featureId);
+                    }
+                }
+            }
+        }
+        foreach (int featureId, binnedIds)
+        {
+            candidateIds.append(featureId);
+        }
+    }
+
+    // The generalized level deviating less than one pixel of the tile
+    int level = GeometryPyramid::levelOf(tileExtent.width() / TileSizeInPixels);
+    Tile newTile;
+    foreach (int featureId, candidateIds)
+    {
+        const SourceFeature& sourceFeature = m_features.at(featureId);
+        if (sourceFeature.removed || !intersects(sourceFeature.extent, tileExtent))
+        {
+            continue;
+        }
+
+        const ParsedFeature& feature = sourceFeature.feature;
+        if (GeometryType::Point == feature.geometry.geometryType())
+        {
+            // Points on the right and upper border belong to the neighbour tile
+            QPointF location = sourceFeature.extent.topLeft();
+            if (location.x() < tileExtent.right() && location.y() < tileExtent.bottom())
+            {
+                newTile.features.append(feature);
+                newTile.featureIds.append(featureId);
+            }
+            continue;
+        }
+
+        Geometry levelGeometry = (0 < level && level <= feature.levels.count()) ? feature.levels.at(level - 1) : feature.geometry;
+        if (!tileExtent.contains(sourceFeature.extent))
+        {
+            levelGeometry = GeometryEngine::clip(levelGeometry, tileEnvelope);
+            if (levelGeometry.isEmpty())
+            {
+                continue;
+            }
+        }
+
+        ParsedFeature tileFeature;
+        tileFeature.geometry = levelGeometry;
+        tileFeature.attributes = feature.attributes;
+        newTile.features.append(tileFeature);
+        newTile.featureIds.append(featureId);
+    }
+
+    m_tiles.insert(tileKey, new Tile(newTile), qMax(1, newTile.features.count()));
+    return newTile;
+}
+
+bool GeoJsonTileIndex::isTileChanged(quint64 tileKey) const
+{
+    return m_allChanged || touchesBins(tileKey, m_changedBins);
+}
+
+void GeoJsonTileIndex::acceptChanges()
+{
+    m_changedBins.clear();
+    m_allChanged = false;
+}
+
+quint64 GeoJsonTileIndex::tileKey(int zoom, int column, int row)
+{
+    return (quint64(zoom) << 58) | (quint64(column) << 29) | quint64(row);
+}
+
+QRectF GeoJsonTileIndex::tileBounds(int zoom, int column, int row)
+{
+    double tileCount = double(1 << zoom);
+    double left = column / tileCount * 360.0 - 180.0;
+    double right = (column + 1) / tileCount * 360.0 - 180.0;
+    double top = qRadiansToDegrees(std::atan(std::sinh(M_PI * (1 - 2 * row / tileCount))));
+    double bottom = qRadiansToDegrees(std::atan(std::sinh(M_PI * (1 - 2 * (row + 1) / tileCount))));
+
+    // The rectangle is in map coordinates, its top is the southern border
+    return QRectF(QPointF(left, bottom), QPointF(right, top));
+}
+
+int GeoJsonTileIndex::tileColumn(double longitude, int zoom)
+{
+    int tileCount = 1 << zoom;
+    int column = int(std::floor((longitude + 180.0) / 360.0 * tileCount));
+    return qBound(0, column, tileCount - 1);
+}
+
+int GeoJsonTileIndex::tileRow(double latitude, int zoom)
+{
+    int tileCount = 1 << zoom;
+    double latitudeRadians = qDegreesToRadians(qBound(-MaxLatitude, latitude, MaxLatitude));
+    double mercatorY = std::log(std::tan(latitudeRadians) + 1 / std::cos(latitudeRadians));
+    int row = int(std::floor((1 - mercatorY / M_PI) / 2 * tileCount));
+    return qBound(0, row, tileCount - 1);
+}
+
+bool GeoJsonTileIndex::intersects(const QRectF &featureExtent, const QRectF &tileExtent)
+{
+    // Unlike QRectF::intersects points and straight lines have an extent
+    return featureExtent.left() <= tileExtent.right() && tileExtent.left() <= featureExtent.right()
+            && featureExtent.top() <= tileExtent.bottom() && tileExtent.top() <= featureExtent.bottom();
+}
+
+void GeoJsonTileIndex::addBins(const QRectF &extent, QSet<quint32> &bins)
+{
+    int firstColumn = tileColumn(extent.left(), BinZoom);
+    int lastColumn = tileColumn(extent.right(), BinZoom);
+    int firstRow = tileRow(extent.bottom(), BinZoom);
+    int lastRow = tileRow(extent.top(), BinZoom);
+    for (int column = firstColumn; column <= lastColumn; column++)
+    {
+        for (int row = firstRow; row <= lastRow; row++)
+        {
+            bins.insert(quint32(column << BinZoom) | quint32(row));
+        }
+    }
+}
+
+bool GeoJsonTileIndex::touchesBins(quint64 tileKey, const QSet<quint32> &bins)
+{
+    if (bins.isEmpty())
+    {
+        return false;
+    }
+
+    // Tiles of the bin zoom and above lie in one bin, the tiles below cover several bins
+    int zoom = int(tileKey >> 58);
+    int column = int((tileKey >> 29) & 0x1fffffff);
+    int row = int(tileKey & 0x1fffffff);
+    if (BinZoom <= zoom)
+    {
+        int shift = zoom - BinZoom;
+        return bins.contains(quint32((column >> shift) << BinZoom) | quint32(row >> shift));
+    }
+
+    int shift = BinZoom - zoom;
+    for (int binColumn = column << shift; binColumn < (column + 1) << shift; binColumn++)
+    {
+        for (int binRow = row << shift; binRow < (row + 1) << shift; binRow++)
+        {
+            if (bins.contains(quint32(binColumn << BinZoom) | quint32(binRow)))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void GeoJsonTileIndex::invalidateTiles(const QSet<quint32> &bins)
+{
+    // Cached tiles of other bins stay valid
+    QList<quint64> cachedTileKeys = m_tiles.keys();
+    foreach (quint64 cachedTileKey, cachedTileKeys)
+    {
+        if (touchesBins(cachedTileKey, bins))
+        {
+            m_tiles.remove(cachedTileKey);
+        }
+    }
+    m_changedBins.unite(bins);
+}
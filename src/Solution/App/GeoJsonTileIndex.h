@@ -0,0 +1,103 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef GEOJSONTILEINDEX_H
+#define GEOJSONTILEINDEX_H
+
+#include "ParsedFeature.h"
+
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
+
+// Tiles of the loaded GeoJSON features following the Web Mercator tiling scheme.
+// The features are binned by the tiles of one fixed zoom level. The features of
+// a tile are clipped out of the generalized level matching the tile resolution
+// when the tile is requested, the recently requested tiles are cached.
+// Inserting or removing features only invalidates the tiles of their bins.
+class GeoJsonTileIndex
+{
+public:
+    struct Tile
+    {
+        ParsedFeatureList features;
+
+        // Id of the source feature of every tile feature
+        QVector<int> featureIds;
+    };
+
+    GeoJsonTileIndex();
+
+    QVector<int> insert(const ParsedFeatureList& features);
+
+    bool features(const QVector<int>& featureIds, ParsedFeatureList& features) const;
+
+    void remove(const QList<int>& featureIds);
+    void remove(Esri::ArcGISRuntime::GeometryType geometryType);
+
+    void clear();
+
+    int count() const;
+
+    static int zoomForResolution(double degreesPerPixel);
+
+    static QList<quint64> coveringTiles(const QRectF& extent, int zoom);
+
+    Tile tile(quint64 tileKey);
+
+    bool isTileChanged(quint64 tileKey) const;
+    void acceptChanges();
+
+private:
+    struct SourceFeature
+    {
+        ParsedFeature feature;
+        QRectF extent;
+        bool removed = false;
+    };
+
+    static quint64 tileKey(int zoom, int column, int row);
+    static QRectF tileBounds(int zoom, int column, int row);
+    static int tileColumn(double longitude, int zoom);
+    static int tileRow(double latitude, int zoom);
+    static bool intersects(const QRectF& featureExtent, const QRectF& tileExtent);
+    static void addBins(const QRectF& extent, QSet<quint32>& bins);
+    static bool touchesBins(quint64 tileKey, const QSet<quint32>& bins);
+
+    void invalidateTiles(const QSet<quint32>& bins);
+
+    QVector<SourceFeature> m_features;
+    QHash<quint32, QVector<int>> m_bins;
+    QVector<int> m_largeFeatureIds;
+    QCache<quint64, Tile> m_tiles;
+    int m_count = 0;
+
+    // Bins of the features inserted or removed since the changes were accepted
+    QSet<quint32> m_changedBins;
+    bool m_allChanged = false;
+};
+
+#endif // GEOJSONTILEINDEX_H
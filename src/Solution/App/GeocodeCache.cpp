@@ -0,0 +1,215 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "GeocodeCache.h"
+
+#include "Polygon.h"
+#include "Polyline.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace
+{
+// Persisted results carry the time they were stored as validator
+const QString StoredPrefix = "stored:";
+
+int partPointCount(const ImmutablePartCollection& parts)
+{
+    int partPointSum = 0;
+    for (int partIndex = 0; partIndex < parts.size(); partIndex++)
+    {
+        partPointSum += parts.part(partIndex).pointCount();
+    }
+    return partPointSum;
+}
+
+int geometryPointCount(const Geometry& geometry)
+{
+    switch (geometry.geometryType())
+    {
+    case GeometryType::Polyline:
+        return partPointCount(Polyline(geometry).parts());
+
+    case GeometryType::Polygon:
+        return partPointCount(Polygon(geometry).parts());
+
+    default:
+        return 1;
+    }
+}
+}
+
+GeocodeCache::GeocodeCache() :
+    m_features(1000 * 1000)
+{
+    QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    setCacheDirectory(QDir(cacheLocation).filePath("geocode"));
+}
+
+void GeocodeCache::setCacheDirectory(const QString &cacheDirectory)
+{
+    m_binaryCache.setCacheDirectory(cacheDirectory);
+}
+
+QString GeocodeCache::cacheDirectory() const
+{
+    return m_binaryCache.cacheDirectory();
+}
+
+void GeocodeCache::setTimeToLive(qint64 seconds)
+{
+    m_timeToLive = seconds;
+}
+
+qint64 GeocodeCache::timeToLive() const
+{
+    return m_timeToLive;
+}
+
+void GeocodeCache::setMaximumPointCount(int maximumPointCount)
+{
+    m_features.setMaxCost(maximumPointCount);
+}
+
+int GeocodeCache::maximumPointCount() const
+{
+    return m_features.maxCost();
+}
+
+bool GeocodeCache::lookup(const QString &normalizedQuery, ParsedFeatureList &features)
+{
+    // The lookup makes the entry the most recently used one
+    ParsedFeatureList* cachedFeatures = m_features.object(normalizedQuery);
+    if (nullptr == cachedFeatures)
+    {
+        return false;
+    }
+
+    features = *cachedFeatures;
+    return true;
+}
+
+GeoJsonBinaryCache::Source GeocodeCache::open(const QString &normalizedQuery, bool ignoreExpiry) const
+{
+    QString validator = m_binaryCache.validator(normalizedQuery);
+    if (!validator.startsWith(StoredPrefix))
+    {
+        return GeoJsonBinaryCache::Source();
+    }
+
+    // Expired results are still served when replaying a session offline
+    QDateTime storedAt = QDateTime::fromSecsSinceEpoch(validator.mid(StoredPrefix.length()).toLongLong(), Qt::UTC);
+    if (!ignoreExpiry && m_timeToLive < storedAt.secsTo(QDateTime::currentDateTimeUtc()))
+    {
+        m_binaryCache.remove(normalizedQuery);
+        return GeoJsonBinaryCache::Source();
+    }
+
+    return m_binaryCache.open(normalizedQuery, validator);
+}
+
+void GeocodeCache::insert(const QString &normalizedQuery, const ParsedFeatureList &features, bool persist)
+{
+    // Large boundaries count by their points, results exceeding the maximum are only persisted
+    m_features.insert(normalizedQuery, new ParsedFeatureList(features), qMax(1, pointCount(features)));
+
+    if (persist)
+    {
+        // The binary copy is written on the worker pool
+        GeoJsonBinaryCache binaryCache = m_binaryCache;
+        QString validator = StoredPrefix + QString::number(QDateTime::currentSecsSinceEpoch());
+        QtConcurrent::run(QThreadPool::globalInstance(), [binaryCache, normalizedQuery, validator, features]()
+        {
+            binaryCache.write(normalizedQuery, validator, features);
+        });
+    }
+}
+
+QStringList GeocodeCache::completions(const QString &normalizedPrefix, int maximumCount) const
+{
+    // Results in memory are reused for every query they complete
+    QStringList matchingQueries;
+    QList<QString> cachedQueries = m_features.keys();
+    foreach (const QString& cachedQuery, cachedQueries)
+    {
+        if (cachedQuery.startsWith(normalizedPrefix))
+        {
+            matchingQueries.append(cachedQuery);
+        }
+    }
+
+    // Shorter queries first, they are the more general ones
+    std::sort(matchingQueries.begin(), matchingQueries.end(), [](const QString& left, const QString& right)
+    {
+        return left.length() < right.length() || (left.length() == right.length() && left < right);
+    });
+    return matchingQueries.mid(0, maximumCount);
+}
+
+QString GeocodeCache::normalizedQuery(const QString &query)
+{
+    // Diacritics are dropped from the decomposed query, punctuation separates words like whitespace does
+    QString decomposedQuery = query.normalized(QString::NormalizationForm_KD).toCaseFolded();
+    QString normalized;
+    normalized.reserve(decomposedQuery.length());
+    foreach (const QChar& character, decomposedQuery)
+    {
+        if (character.isMark())
+        {
+            continue;
+        }
+        normalized.append(character.isLetterOrNumber() ? character : QChar(' '));
+    }
+    return normalized.simplified();
+}
+
+void GeocodeCache::sortByImportance(ParsedFeatureList &features)
+{
+    // Binary copies are spatially ordered, the results are ranked by their importance again
+    std::stable_sort(features.begin(), features.end(), [](const ParsedFeature& left, const ParsedFeature& right)
+    {
+        return right.attributes.value("importance").toDouble() < left.attributes.value("importance").toDouble();
+    });
+}
+
+int GeocodeCache::pointCount(const ParsedFeatureList &features)
+{
+    int featurePointCount = 0;
+    foreach (const ParsedFeature& feature, features)
+    {
+        featurePointCount += geometryPointCount(feature.geometry);
+        foreach (const Geometry& level, feature.levels)
+        {
+            featurePointCount += geometryPointCount(level);
+        }
+    }
+    return featurePointCount;
+}
@@ -0,0 +1,74 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef GEOCODECACHE_H
+#define GEOCODECACHE_H
+
+#include "GeoJsonBinaryCache.h"
+#include "ParsedFeature.h"
+
+#include <QCache>
+#include <QString>
+#include <QStringList>
+
+// Geocode results keyed by their normalized query, so that queries only differing
+// in case, whitespace, punctuation or diacritics share one entry. The parsed features
+// of the recently used queries stay in memory ready to be appended, every result is
+// also persisted as a binary copy holding the generalized levels.
+class GeocodeCache
+{
+public:
+    GeocodeCache();
+
+    void setCacheDirectory(const QString& cacheDirectory);
+    QString cacheDirectory() const;
+
+    void setTimeToLive(qint64 seconds);
+    qint64 timeToLive() const;
+
+    void setMaximumPointCount(int maximumPointCount);
+    int maximumPointCount() const;
+
+    bool lookup(const QString& normalizedQuery, ParsedFeatureList& features);
+
+    GeoJsonBinaryCache::Source open(const QString& normalizedQuery, bool ignoreExpiry) const;
+
+    void insert(const QString& normalizedQuery, const ParsedFeatureList& features, bool persist);
+
+    QStringList completions(const QString& normalizedPrefix, int maximumCount) const;
+
+    static QString normalizedQuery(const QString& query);
+
+    static void sortByImportance(ParsedFeatureList& features);
+
+private:
+    Q_DISABLE_COPY(GeocodeCache)
+
+    static int pointCount(const ParsedFeatureList& features);
+
+    QCache<QString, ParsedFeatureList> m_features;
+    GeoJsonBinaryCache m_binaryCache;
+    qint64 m_timeToLive = 30 * 24 * 60 * 60;
+};
+
+#endif // GEOCODECACHE_H
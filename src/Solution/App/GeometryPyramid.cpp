@@ -0,0 +1,130 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "GeometryPyramid.h"
+
+#include "GeometryEngine.h"
+#include "Graphic.h"
+
+using namespace Esri::ArcGISRuntime;
+
+namespace
+{
+// About 20 meters up to about 20 kilometers at the equator
+const double BaseTolerance = 0.0002;
+const int LevelCount = 5;
+}
+
+GeometryPyramid::GeometryPyramid()
+{
+}
+
+QList<Geometry> GeometryPyramid::createLevels(const Geometry &geometry)
+{
+    QList<Geometry> levels;
+    GeometryType geometryType = geometry.geometryType();
+    if (GeometryType::Polyline != geometryType && GeometryType::Polygon != geometryType)
+    {
+        return levels;
+    }
+
+    // Every level is generalized from the previous one, which is much cheaper
+    // for dense geometries and adds at most a third to the deviation.
+    Geometry previousLevel = geometry;
+    for (int level = 1; level <= LevelCount; level++)
+    {
+        Geometry generalized = GeometryEngine::generalize(previousLevel, levelTolerance(level), true);
+        if (generalized.isEmpty())
+        {
+            // Small parts would vanish, they keep the last shape
+            generalized = previousLevel;
+        }
+        levels.append(generalized);
+        previousLevel = generalized;
+    }
+    return levels;
+}
+
+void GeometryPyramid::insert(Graphic *graphic, const Geometry &geometry, const QList<Geometry> &levels)
+{
+    if (levels.isEmpty())
+    {
+        return;
+    }
+
+    QVector<Geometry> geometries;
+    geometries.reserve(levels.count() + 1);
+    geometries.append(geometry);
+    foreach (const Geometry& levelGeometry, levels)
+    {
+        geometries.append(levelGeometry);
+    }
+
+    if (0 < m_level)
+    {
+        graphic->setGeometry(geometries.at(qMin(m_level, geometries.count() - 1)));
+    }
+    m_geometries.insert(graphic, geometries);
+}
+
+void GeometryPyramid::remove(Graphic *graphic)
+{
+    m_geometries.remove(graphic);
+}
+
+void GeometryPyramid::clear()
+{
+    m_geometries.clear();
+}
+
+void GeometryPyramid::setResolution(double degreesPerPixel)
+{
+    int level = levelOf(degreesPerPixel);
+    if (level == m_level)
+    {
+        return;
+    }
+
+    m_level = level;
+    for (auto geometryIterator = m_geometries.constBegin(); geometryIterator != m_geometries.constEnd(); ++geometryIterator)
+    {
+        const QVector<Geometry>& geometries = geometryIterator.value();
+        geometryIterator.key()->setGeometry(geometries.at(qMin(level, geometries.count() - 1)));
+    }
+}
+
+double GeometryPyramid::levelTolerance(int level)
+{
+    // Level 1 has the base tolerance and every level multiplies it by four
+    return BaseTolerance * (1 << (2 * (level - 1)));
+}
+
+int GeometryPyramid::levelOf(double degreesPerPixel)
+{
+    int level = 0;
+    while (level < LevelCount && levelTolerance(level + 1) <= degreesPerPixel)
+    {
+        level++;
+    }
+    return level;
+}
@@ -0,0 +1,69 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef GEOMETRYPYRAMID_H
+#define GEOMETRYPYRAMID_H
+
+#include "Geometry.h"
+
+namespace Esri
+{
+namespace ArcGISRuntime
+{
+class Graphic;
+}
+}
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+// Generalized versions of line and area geometries in WGS84.
+// Every level allows four times the deviation of the previous one, the graphics
+// show the coarsest level deviating less than one pixel from the full geometry.
+class GeometryPyramid
+{
+public:
+    GeometryPyramid();
+
+    static QList<Esri::ArcGISRuntime::Geometry> createLevels(const Esri::ArcGISRuntime::Geometry& geometry);
+
+    void insert(Esri::ArcGISRuntime::Graphic* graphic, const Esri::ArcGISRuntime::Geometry& geometry, const QList<Esri::ArcGISRuntime::Geometry>& levels);
+
+    void remove(Esri::ArcGISRuntime::Graphic* graphic);
+
+    void clear();
+
+    void setResolution(double degreesPerPixel);
+
+    static int levelOf(double degreesPerPixel);
+
+private:
+    static double levelTolerance(int level);
+
+    // The full geometry followed by the levels of every graphic
+    QHash<Esri::ArcGISRuntime::Graphic*, QVector<Esri::ArcGISRuntime::Geometry>> m_geometries;
+    int m_level = 0;
+};
+
+#endif // GEOMETRYPYRAMID_H
@@ -0,0 +1,340 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "GraphicHitIndex.h"
+
+#include "Envelope.h"
+#include "GeometryEngine.h"
+#include "Graphic.h"
+#include "GraphicListModel.h"
+#include "GraphicsOverlay.h"
+#include "MapQuickView.h"
+#include "Point.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace
+{
+// Cells from about 10 cm up to the whole world
+const int LevelCount = 30;
+const double BaseCellSize = 1e-6;
+
+bool isWgs84(const Geometry& geometry)
+{
+    return 4326 == geometry.spatialReference().wkid();
+}
+
+bool intersects(const QRectF& graphicExtent, const QRectF& extent)
+{
+    // Points have empty extents, so the bounds are compared inclusively
+    return graphicExtent.left() <= extent.right() && extent.left() <= graphicExtent.right()
+            && graphicExtent.top() <= extent.bottom() && extent.top() <= graphicExtent.bottom();
+}
+}
+
+GraphicHitIndex::GraphicHitIndex(QObject *parent) :
+    QObject(parent),
+    m_cellsByLevel(LevelCount)
+{
+}
+
+void GraphicHitIndex::addOverlay(GraphicsOverlay *overlay, double symbolRadius)
+{
+    IndexedOverlay indexedOverlay;
+    indexedOverlay.overlay = overlay;
+    indexedOverlay.symbolRadius = symbolRadius;
+    m_overlays.append(indexedOverlay);
+
+    // Every change of the graphics is applied to the index
+    GraphicListModel* graphics = overlay->graphics();
+    connect(graphics, &QAbstractItemModel::rowsInserted, this, [this, overlay](const QModelIndex&, int first, int last)
+    {
+        insertGraphics(overlay, first, last);
+    });
+    connect(graphics, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this, overlay](const QModelIndex&, int first, int last)
+    {
+        removeGraphics(overlay, first, last);
+    });
+    connect(graphics, &QAbstractItemModel::modelAboutToBeReset, this, [this, overlay]()
+    {
+        removeOverlayGraphics(overlay);
+    });
+    connect(graphics, &QAbstractItemModel::modelReset, this, [this, overlay]()
+    {
+        insertGraphics(overlay, 0, overlay->graphics()->size() - 1);
+    });
+
+    insertGraphics(overlay, 0, graphics->size() - 1);
+}
+
+QList<GraphicsOverlay*> GraphicHitIndex::overlays() const
+{
+    QList<GraphicsOverlay*> indexedOverlays;
+    foreach (const IndexedOverlay& indexedOverlay, m_overlays)
+    {
+        indexedOverlays.append(indexedOverlay.overlay);
+    }
+    return indexedOverlays;
+}
+
+int GraphicHitIndex::count() const
+{
+    return m_entries.count();
+}
+
+QList<GraphicHitIndex::Hit> GraphicHitIndex::hitTest(MapQuickView *mapView, const QPointF &screenLocation, double pixelTolerance, int maxResults) const
+{
+    QList<Hit> hits;
+    Point clickLocation = mapView->screenToLocation(screenLocation.x(), screenLocation.y());
+    if (clickLocation.isEmpty())
+    {
+        return hits;
+    }
+    Point clickLocationWgs84 = GeometryEngine::project(clickLocation, SpatialReference::wgs84());
+
+    for (int rank = 0; rank < m_overlays.count(); rank++)
+    {
+        const IndexedOverlay& indexedOverlay = m_overlays.at(rank);
+        if (!indexedOverlay.overlay->isVisible())
+        {
+            continue;
+        }
+
+        // The tolerance box around the click also covers the symbols of point graphics
+        double tolerance = pixelTolerance + indexedOverlay.symbolRadius;
+        Point lowerLeft = mapView->screenToLocation(screenLocation.x() - tolerance, screenLocation.y() + tolerance);
+        Point upperRight = mapView->screenToLocation(screenLocation.x() + tolerance, screenLocation.y() - tolerance);
+        Envelope toleranceExtent = GeometryEngine::project(Envelope(lowerLeft, upperRight), SpatialReference::wgs84()).extent();
+        QRectF toleranceRect(QPointF(toleranceExtent.xMin(), toleranceExtent.yMin()), QPointF(toleranceExtent.xMax(), toleranceExtent.yMax()));
+
+        QList<Graphic*> candidateGraphics = candidates(toleranceRect);
+        foreach (Graphic* candidateGraphic, candidateGraphics)
+        {
+            const Entry& entry = m_entries[candidateGraphic];
+            if (indexedOverlay.overlay != entry.overlay || !candidateGraphic->isVisible())
+            {
+                continue;
+            }
+
+            // Only the candidates are tested against their exact geometry
+            Geometry hitGeometry = candidateGraphic->geometry();
+            if (!isWgs84(hitGeometry))
+            {
+                hitGeometry = GeometryEngine::project(hitGeometry, SpatialReference::wgs84());
+            }
+            if (!GeometryEngine::intersects(hitGeometry, toleranceExtent))
+            {
+                continue;
+            }
+
+            Hit hit;
+            hit.overlay = entry.overlay;
+            hit.graphic = candidateGraphic;
+            hit.rank = rank;
+            hit.distance = GeometryEngine::distance(hitGeometry, clickLocationWgs84);
+            hit.area = entry.extent.width() * entry.extent.height();
+            hits.append(hit);
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(), [](const Hit& left, const Hit& right)
+    {
+        if (left.rank != right.rank)
+        {
+            return left.rank < right.rank;
+        }
+        if (left.distance != right.distance)
+        {
+            return left.distance < right.distance;
+        }
+        return left.area < right.area;
+    });
+    if (maxResults < hits.count())
+    {
+        hits.erase(hits.begin() + maxResults, hits.end());
+    }
+    return hits;
+}
+
+void GraphicHitIndex::insertGraphics(GraphicsOverlay *overlay, int first, int last)
+{
+    GraphicListModel* graphics = overlay->graphics();
+    for (int row = first; row <= last; row++)
+    {
+        insert(overlay, graphics->at(row));
+    }
+}
+
+void GraphicHitIndex::removeGraphics(GraphicsOverlay *overlay, int first, int last)
+{
+    GraphicListModel* graphics = overlay->graphics();
+    for (int row = first; row <= last; row++)
+    {
+        remove(graphics->at(row));
+    }
+}
+
+void GraphicHitIndex::removeOverlayGraphics(GraphicsOverlay *overlay)
+{
+    QList<Graphic*> overlayGraphics;
+    for (auto entryIterator = m_entries.constBegin(); entryIterator != m_entries.constEnd(); ++entryIterator)
+    {
+        if (overlay == entryIterator.value().overlay)
+        {
+            overlayGraphics.append(entryIterator.key());
+        }
+    }
+
+    foreach (Graphic* overlayGraphic, overlayGraphics)
+    {
+        remove(overlayGraphic);
+    }
+}
+
+void GraphicHitIndex::insert(GraphicsOverlay *overlay, Graphic *graphic)
+{
+    if (nullptr == graphic || graphic->geometry().isEmpty())
+    {
+        return;
+    }
+
+    remove(graphic);
+    Envelope graphicExtent = graphic->geometry().extent();
+    if (!isWgs84(graphicExtent))
+    {
+        graphicExtent = GeometryEngine::project(graphicExtent, SpatialReference::wgs84()).extent();
+    }
+
+    Entry entry;
+    entry.overlay = overlay;
+    entry.extent = QRectF(QPointF(graphicExtent.xMin(), graphicExtent.yMin()), QPointF(graphicExtent.xMax(), graphicExtent.yMax()));
+    entry.level = levelForSize(qMax(entry.extent.width(), entry.extent.height()));
+    double cellSize = cellSizeOfLevel(entry.level);
+    entry.cellKey = cellKey(qint64(std::floor(entry.extent.left() / cellSize)), qint64(std::floor(entry.extent.top() / cellSize)));
+    m_cellsByLevel[entry.level][entry.cellKey].append(graphic);
+    m_entries.insert(graphic, entry);
+}
+
+void GraphicHitIndex::remove(Graphic *graphic)
+{
+    auto entryIterator = m_entries.find(graphic);
+    if (entryIterator == m_entries.end())
+    {
+        return;
+    }
+
+    QHash<quint64, QVector<Graphic*>>& cells = m_cellsByLevel[entryIterator->level];
+    auto cellIterator = cells.find(entryIterator->cellKey);
+    if (cellIterator != cells.end())
+    {
+        cellIterator->removeOne(graphic);
+        if (cellIterator->isEmpty())
+        {
+            cells.erase(cellIterator);
+        }
+    }
+    m_entries.erase(entryIterator);
+}
+
+QList<Graphic*> GraphicHitIndex::candidates(const QRectF &extent) const
+{
+    QList<Graphic*> candidateGraphics;
+    for (int level = 0; level < LevelCount; level++)
+    {
+        const QHash<quint64, QVector<Graphic*>>& cells = m_cellsByLevel.at(level);
+        if (cells.isEmpty())
+        {
+            continue;
+        }
+
+        // Graphics reach at most one cell beyond the cell of their lower left corner
+        double cellSize = cellSizeOfLevel(level);
+        qint64 firstColumn = qint64(std::floor(extent.left() / cellSize)) - 1;
+        qint64 lastColumn = qint64(std::floor(extent.right() / cellSize));
+        qint64 firstRow = qint64(std::floor(extent.top() / cellSize)) - 1;
+        qint64 lastRow = qint64(std::floor(extent.bottom() / cellSize));
+        QList<const QVector<Graphic*>*> visitedCells;
+        if ((lastColumn - firstColumn + 1) * (lastRow - firstRow + 1) < cells.count())
+        {
+            for (qint64 column = firstColumn; column <= lastColumn; column++)
+            {
+                for (qint64 row = firstRow; row <= lastRow; row++)
+                {
+                    auto cellIterator = cells.constFind(cellKey(column, row));
+                    if (cellIterator != cells.constEnd())
+                    {
+                        visitedCells.append(&cellIterator.value());
+                    }
+                }
+            }
+        }
+        else
+        {
+            // Small levels are scanned instead of visiting the many empty cells of the extent
+            for (auto cellIterator = cells.constBegin(); cellIterator != cells.constEnd(); ++cellIterator)
+            {
+                qint64 column = qint32(quint32(cellIterator.key() >> 32));
+                qint64 row = qint32(quint32(cellIterator.key()));
+                if (firstColumn <= column && column <= lastColumn && firstRow <= row && row <= lastRow)
+                {
+                    visitedCells.append(&cellIterator.value());
+                }
+            }
+        }
+
+        foreach (const QVector<Graphic*>* cell, visitedCells)
+        {
+            foreach (Graphic* graphic, *cell)
+            {
+                if (intersects(m_entries.value(graphic).extent, extent))
+                {
+                    candidateGraphics.append(graphic);
+                }
+            }
+        }
+    }
+    return candidateGraphics;
+}
+
+int GraphicHitIndex::levelForSize(double size)
+{
+    int level = 0;
+    while (level < LevelCount - 1 && cellSizeOfLevel(level) < size)
+    {
+        level++;
+    }
+    return level;
+}
+
+double GraphicHitIndex::cellSizeOfLevel(int level)
+{
+    return std::ldexp(BaseCellSize, level);
+}
+
+quint64 GraphicHitIndex::cellKey(qint64 column, qint64 row)
+{
+    return (quint64(quint32(qint32(column))) << 32) | quint64(quint32(qint32(row)));
+}
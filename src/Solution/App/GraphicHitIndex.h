@@ -0,0 +1,108 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef GRAPHICHITINDEX_H
+#define GRAPHICHITINDEX_H
+
+namespace Esri
+{
+namespace ArcGISRuntime
+{
+class Graphic;
+class GraphicsOverlay;
+class MapQuickView;
+}
+}
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+// Hierarchical grid over the graphics of several overlays for synchronous hit testing.
+// Every graphic is binned into the level whose cells are at least as large as its WGS84
+// extent, by the cell holding the lower left corner of the extent. The graphic models of
+// the overlays are observed, so the index follows every insert, remove and reset.
+class GraphicHitIndex : public QObject
+{
+    Q_OBJECT
+public:
+    struct Hit
+    {
+        Esri::ArcGISRuntime::GraphicsOverlay* overlay = nullptr;
+        Esri::ArcGISRuntime::Graphic* graphic = nullptr;
+
+        // Overlays added first rank first, then the closest and smallest graphics
+        int rank = 0;
+        double distance = 0;
+        double area = 0;
+    };
+
+    explicit GraphicHitIndex(QObject *parent = nullptr);
+
+    void addOverlay(Esri::ArcGISRuntime::GraphicsOverlay* overlay, double symbolRadius);
+
+    QList<Esri::ArcGISRuntime::GraphicsOverlay*> overlays() const;
+
+    int count() const;
+
+    QList<Hit> hitTest(Esri::ArcGISRuntime::MapQuickView* mapView, const QPointF& screenLocation, double pixelTolerance, int maxResults) const;
+
+private:
+    struct IndexedOverlay
+    {
+        Esri::ArcGISRuntime::GraphicsOverlay* overlay = nullptr;
+
+        // Pixels the symbols extend beyond their point geometries
+        double symbolRadius = 0;
+    };
+
+    struct Entry
+    {
+        Esri::ArcGISRuntime::GraphicsOverlay* overlay = nullptr;
+        int level = 0;
+        quint64 cellKey = 0;
+        QRectF extent;
+    };
+
+    void insertGraphics(Esri::ArcGISRuntime::GraphicsOverlay* overlay, int first, int last);
+    void removeGraphics(Esri::ArcGISRuntime::GraphicsOverlay* overlay, int first, int last);
+    void removeOverlayGraphics(Esri::ArcGISRuntime::GraphicsOverlay* overlay);
+
+    void insert(Esri::ArcGISRuntime::GraphicsOverlay* overlay, Esri::ArcGISRuntime::Graphic* graphic);
+    void remove(Esri::ArcGISRuntime::Graphic* graphic);
+
+    QList<Esri::ArcGISRuntime::Graphic*> candidates(const QRectF& extent) const;
+
+    static int levelForSize(double size);
+    static double cellSizeOfLevel(int level);
+    static quint64 cellKey(qint64 column, qint64 row);
+
+    QList<IndexedOverlay> m_overlays;
+    QHash<Esri::ArcGISRuntime::Graphic*, Entry> m_entries;
+    QVector<QHash<quint64, QVector<Esri::ArcGISRuntime::Graphic*>>> m_cellsByLevel;
+};
+
+#endif // GRAPHICHITINDEX_H
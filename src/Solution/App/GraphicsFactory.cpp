@@ -23,13 +23,18 @@
 //
 #include "GraphicsFactory.h"
 
+#include "GeometryPyramid.h"
+
 #include "GeometryEngine.h"
 #include "Graphic.h"
 #include "GraphicsOverlay.h"
 #include "PolygonBuilder.h"
 #include "PolylineBuilder.h"
 
+#include <QJsonDocument>
 #include <QJsonObject>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 using namespace Esri::ArcGISRuntime;
 
@@ -38,49 +43,116 @@ GraphicsFactory::GraphicsFactory(QObject *parent) : QObject(parent)
 
 }
 
-bool GraphicsFactory::createGraphics(const QJsonArray &featuresArray,
-                                     Esri::ArcGISRuntime::GraphicsOverlay *pointsOverlay,
-                                     Esri::ArcGISRuntime::GraphicsOverlay *linesOverlay,
-                                     Esri::ArcGISRuntime::GraphicsOverlay *areasOverlay)
+ParsedFeatureList GraphicsFactory::parseFeatureCollection(const QByteArray &geoJson, const CancelCheck &isCanceled)
+{
+    QJsonDocument geoJsonDocument = QJsonDocument::fromJson(geoJson);
+    if (geoJsonDocument.isNull())
+    {
+        qDebug() << "JSON is invalid!";
+        return ParsedFeatureList();
+    }
+    if (!geoJsonDocument.isObject())
+    {
+        qDebug() << "JSON document is not an object!";
+        return ParsedFeatureList();
+    }
+
+    QJsonObject geoJsonObject = geoJsonDocument.object();
+    QJsonArray geoJsonFeaturesArray = geoJsonObject["features"].toArray();
+    return parseFeatures(geoJsonFeaturesArray, isCanceled);
+}
+
+ParsedFeatureList GraphicsFactory::parseFeatureArray(const QByteArray &featuresJson, const CancelCheck &isCanceled)
+{
+    QJsonDocument featuresDocument = QJsonDocument::fromJson(featuresJson);
+    if (!featuresDocument.isArray())
+    {
+        qDebug() << "JSON features are invalid!";
+        return ParsedFeatureList();
+    }
+
+    return parseFeatures(featuresDocument.array(), isCanceled);
+}
+
+ParsedFeatureList GraphicsFactory::parseFeatures(const QJsonArray &featuresArray, const CancelCheck &isCanceled)
 {
-    bool added = false;
-    foreach (const QJsonValue& featureValue, featuresArray)
+    // Small arrays are not worth the scheduling
+    const int chunkSize = 512;
+    int featureCount = featuresArray.count();
+    if (featureCount < 2 * chunkSize || QThreadPool::globalInstance()->maxThreadCount() < 2)
     {
+        return parseFeatureRange(featuresArray, 0, featureCount, isCanceled);
+    }
+
+    // The chunks are parsed by the thread pool and the calling thread,
+    // the results keep the order of the chunks.
+    QVector<QPair<int, int>> chunks;
+    for (int chunkStart = 0; chunkStart < featureCount; chunkStart += chunkSize)
+    {
+        chunks.append(qMakePair(chunkStart, qMin(chunkStart + chunkSize, featureCount)));
+    }
+
+    std::function<ParsedFeatureList(const QPair<int, int>&)> parseChunk = [featuresArray, isCanceled](const QPair<int, int>& chunk)
+    {
+        return parseFeatureRange(featuresArray, chunk.first, chunk.second, isCanceled);
+    };
+    QList<ParsedFeatureList> chunkFeatures = QtConcurrent::blockingMapped<QList<ParsedFeatureList>>(chunks, parseChunk);
+    if (isCanceled())
+    {
+        return ParsedFeatureList();
+    }
+
+    ParsedFeatureList features;
+    features.reserve(featureCount);
+    foreach (const ParsedFeatureList& parsedChunk, chunkFeatures)
+    {
+        features.append(parsedChunk);
+    }
+    return features;
+}
+
+ParsedFeatureList GraphicsFactory::parseFeatureRange(const QJsonArray &featuresArray, int begin, int end, const CancelCheck &isCanceled)
+{
+    ParsedFeatureList features;
+    for (int featureIndex = begin; featureIndex < end; featureIndex++)
+    {
+        if (isCanceled())
+        {
+            return ParsedFeatureList();
+        }
+
+        // Only const access, the array is shared between the threads
+        const QJsonValue featureValue = featuresArray.at(featureIndex);
         if (featureValue.isObject())
         {
             QJsonObject geojsonFeature = featureValue.toObject();
-            QJsonObject geojsonGeometry = geojsonFeature["geometry"].toObject();
-            QJsonValue geometryTypeValue = geojsonGeometry["type"];
+            QJsonObject geojsonGeometry = geojsonFeature.value("geometry").toObject();
+            QJsonValue geometryTypeValue = geojsonGeometry.value("type");
             if (geometryTypeValue.isString())
             {
-                QJsonValue coordinatesValue = geojsonGeometry["coordinates"];
+                QJsonValue coordinatesValue = geojsonGeometry.value("coordinates");
                 if (coordinatesValue.isArray())
                 {
-                    QJsonObject properties = geojsonFeature["properties"].toObject();
+                    QJsonObject properties = geojsonFeature.value("properties").toObject();
                     QVariantMap propertyMap = properties.toVariantMap();
 
                     QJsonArray coordinatesArray = coordinatesValue.toArray();
                     QString geometryType = geometryTypeValue.toString();
                     if (0 == QString::compare("Point", geometryType))
                     {
-                        QJsonArray coordinatesArray = coordinatesValue.toArray();
                         if (1 < coordinatesArray.count())
                         {
                             double x = coordinatesArray[0].toDouble();
                             double y = coordinatesArray[1].toDouble();
                             Point location(x, y, SpatialReference::wgs84());
-                            Graphic* graphic = new Graphic(location, propertyMap, this);
-                            pointsOverlay->graphics()->append(graphic);
-                            added = true;
+                            features.append({ location, propertyMap });
                         }
                     }
                     // TODO: MultiPoint, Polyline and so on implementations
                     else if (0 == QString::compare("LineString", geometryType))
                     {
                         Polyline polyline = createPolyline(coordinatesArray);
-                        Graphic* geojsonGraphic = new Graphic(polyline, propertyMap, this);
-                        linesOverlay->graphics()->append(geojsonGraphic);
-                        added = true;
+                        features.append({ polyline, propertyMap, GeometryPyramid::createLevels(polyline) });
                     }
                     else if (0 == QString::compare("MultiLineString", geometryType))
                     {
@@ -91,18 +163,14 @@ bool GraphicsFactory::createGraphics(const QJsonArray &featuresArray,
                             {
                                 QJsonArray polylineCoordinatesArray = polylineValue.toArray();
                                 Polyline polyline = createPolyline(polylineCoordinatesArray);
-                                Graphic* geojsonGraphic = new Graphic(polyline, propertyMap, this);
-                                linesOverlay->graphics()->append(geojsonGraphic);
-                                added = true;
+                                features.append({ polyline, propertyMap, GeometryPyramid::createLevels(polyline) });
                             }
                         }
                     }
                     else if (0 == QString::compare("Polygon", geometryType))
                     {
                         Polygon polygon = createPolygon(coordinatesArray);
-                        Graphic* geojsonGraphic = new Graphic(polygon, propertyMap, this);
-                        areasOverlay->graphics()->append(geojsonGraphic);
-                        added = true;
+                        features.append({ polygon, propertyMap, GeometryPyramid::createLevels(polygon) });
                     }
                     else if (0 == QString::compare("MultiPolygon", geometryType))
                     {
@@ -113,9 +181,7 @@ bool GraphicsFactory::createGraphics(const QJsonArray &featuresArray,
                             {
                                 QJsonArray polygonCoordinatesArray = polygonValue.toArray();
                                 Polygon polygon = createPolygon(polygonCoordinatesArray);
-                                Graphic* geojsonGraphic = new Graphic(polygon, propertyMap, this);
-                                areasOverlay->graphics()->append(geojsonGraphic);
-                                added = true;
+                                features.append({ polygon, propertyMap, GeometryPyramid::createLevels(polygon) });
                             }
                         }
                     }
@@ -124,7 +190,61 @@ bool GraphicsFactory::createGraphics(const QJsonArray &featuresArray,
         }
     }
 
-    return added;
+    return features;
+}
+
+QList<Graphic*> GraphicsFactory::createGraphics(const ParsedFeatureList &features,
+                                                Esri::ArcGISRuntime::GraphicsOverlay *pointsOverlay,
+                                                Esri::ArcGISRuntime::GraphicsOverlay *linesOverlay,
+                                                Esri::ArcGISRuntime::GraphicsOverlay *areasOverlay)
+{
+    // One entry per feature, features of other geometry types have none
+    QList<Graphic*> featureGraphics;
+    QList<Graphic*> pointGraphics;
+    QList<Graphic*> lineGraphics;
+    QList<Graphic*> areaGraphics;
+    foreach (const ParsedFeature& feature, features)
+    {
+        Graphic* featureGraphic = nullptr;
+        switch (feature.geometry.geometryType())
+        {
+        case GeometryType::Point:
+            featureGraphic = new Graphic(feature.geometry, feature.attributes, this);
+            pointGraphics.append(featureGraphic);
+            break;
+
+        case GeometryType::Polyline:
+            featureGraphic = new Graphic(feature.geometry, feature.attributes, this);
+            lineGraphics.append(featureGraphic);
+            break;
+
+        case GeometryType::Polygon:
+            featureGraphic = new Graphic(feature.geometry, feature.attributes, this);
+            areaGraphics.append(featureGraphic);
+            break;
+
+        default:
+            break;
+        }
+        featureGraphics.append(featureGraphic);
+    }
+
+    // Every append notifies the model listeners and invalidates the rendering
+    // so each overlay is only touched once.
+    if (!pointGraphics.isEmpty())
+    {
+        pointsOverlay->graphics()->append(pointGraphics);
+    }
+    if (!lineGraphics.isEmpty())
+    {
+        linesOverlay->graphics()->append(lineGraphics);
+    }
+    if (!areaGraphics.isEmpty())
+    {
+        areasOverlay->graphics()->append(areaGraphics);
+    }
+
+    return featureGraphics;
 }
 
 Polygon GraphicsFactory::createPolygon(const QJsonArray &coordinatesArray)
@@ -24,6 +24,7 @@
 #ifndef GRAPHICSFACTORY_H
 #define GRAPHICSFACTORY_H
 
+#include "ParsedFeature.h"
 #include "Polygon.h"
 #include "Polyline.h"
 
@@ -31,6 +32,7 @@ namespace Esri
 {
 namespace ArcGISRuntime
 {
+class Graphic;
 class GraphicsOverlay;
 }
 }
@@ -44,16 +46,24 @@ class GraphicsFactory : public QObject
 public:
     explicit GraphicsFactory(QObject *parent = nullptr);
 
-    bool createGraphics(const QJsonArray& featuresArray,
-                        Esri::ArcGISRuntime::GraphicsOverlay* pointsOverlay,
-                        Esri::ArcGISRuntime::GraphicsOverlay* linesOverlay,
-                        Esri::ArcGISRuntime::GraphicsOverlay* areasOverlay);
+    static ParsedFeatureList parseFeatureCollection(const QByteArray& geoJson, const CancelCheck& isCanceled);
+
+    static ParsedFeatureList parseFeatureArray(const QByteArray& featuresJson, const CancelCheck& isCanceled);
+
+    static ParsedFeatureList parseFeatures(const QJsonArray& featuresArray, const CancelCheck& isCanceled);
+
+    QList<Esri::ArcGISRuntime::Graphic*> createGraphics(const ParsedFeatureList& features,
+                                                        Esri::ArcGISRuntime::GraphicsOverlay* pointsOverlay,
+                                                        Esri::ArcGISRuntime::GraphicsOverlay* linesOverlay,
+                                                        Esri::ArcGISRuntime::GraphicsOverlay* areasOverlay);
 
 signals:
 
 private:
-    Esri::ArcGISRuntime::Polygon createPolygon(const QJsonArray& coordinatesArray);
-    Esri::ArcGISRuntime::Polyline createPolyline(const QJsonArray& coordinatesArray);
+    static ParsedFeatureList parseFeatureRange(const QJsonArray& featuresArray, int begin, int end, const CancelCheck& isCanceled);
+
+    static Esri::ArcGISRuntime::Polygon createPolygon(const QJsonArray& coordinatesArray);
+    static Esri::ArcGISRuntime::Polyline createPolyline(const QJsonArray& coordinatesArray);
 };
 
 #endif // GRAPHICSFACTORY_H
@@ -23,6 +23,11 @@
 //
 #include "NominatimPlaceLayer.h"
 
+#include "FeatureParsePipeline.h"
+#include "GraphicsFactory.h"
+#include "RequestScheduler.h"
+#include "ResponseCache.h"
+
 #include "FeatureCollectionTable.h"
 #include "GeometryEngine.h"
 #include "Graphic.h"
@@ -36,20 +41,71 @@
 #include "SimpleRenderer.h"
 #include "TextSymbol.h"
 
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFutureWatcher>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QJsonObject>
 #include <QNetworkReply>
+#include <QProcessEnvironment>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QUrlQuery>
+#include <QtConcurrent>
 #include <QUuid>
 
 using namespace Esri::ArcGISRuntime;
 
+namespace
+{
+// The lookup a Nominatim request belongs to
+const QNetworkRequest::Attribute LookupIdAttribute = QNetworkRequest::Attribute(QNetworkRequest::User + 1);
+
+// The suggestion generation a request belongs to
+const QNetworkRequest::Attribute SuggestionAttribute = QNetworkRequest::Attribute(QNetworkRequest::User + 2);
+
+// Places of the gazetteer answering one query
+const int MaximumGazetteerPlaceCount = 10;
+
+// Suggestions start with the second character typed and wait for a pause in typing
+const int MinimumSuggestionLength = 2;
+const int MaximumSuggestionCount = 8;
+const int SuggestionDelay = 300;
+
+// Throttled requests are sent again after a growing delay, then the lookup fails
+const int MaximumAttemptCount = 5;
+}
+
 NominatimPlaceLayer::NominatimPlaceLayer(QObject *parent) :
     QObject(parent),
     m_networkAccessManager(new QNetworkAccessManager(this)),
+    m_scheduler(new RequestScheduler(m_networkAccessManager, this)),
+    m_parsePipeline(new FeatureParsePipeline(this)),
+    m_batchPipeline(new FeatureParsePipeline(this)),
     m_overlay(new GraphicsOverlay(this)),
-    m_pointOverlay(new GraphicsOverlay(this))
+    m_pointOverlay(new GraphicsOverlay(this)),
+    m_suggestionTimer(new QTimer(this))
 {
     connect(m_networkAccessManager, &QNetworkAccessManager::finished, this, &NominatimPlaceLayer::networkRequestFinished);
+    connect(m_scheduler, &RequestScheduler::requestSent, this, &NominatimPlaceLayer::requestSent);
+    connect(m_parsePipeline, &FeatureParsePipeline::featuresParsed, this, &NominatimPlaceLayer::featuresParsed);
+    connect(m_batchPipeline, &FeatureParsePipeline::featuresParsed, this, &NominatimPlaceLayer::featuresParsed);
+
+    // The usage policy of Nominatim permits one request per second
+    m_scheduler->setRate(1, 1);
+
+    m_suggestionTimer->setSingleShot(true);
+    m_suggestionTimer->setInterval(SuggestionDelay);
+    connect(m_suggestionTimer, &QTimer::timeout, this, &NominatimPlaceLayer::startSuggestions);
+
+    // Suggestions of places beyond the cache and the gazetteer need an own Nominatim or Photon server
+    QProcessEnvironment systemEnvironment = QProcessEnvironment::systemEnvironment();
+    QString suggestionUrlName = "nominatim.suggest";
+    if (systemEnvironment.contains(suggestionUrlName))
+    {
+        setSuggestionUrl(QUrl(systemEnvironment.value(suggestionUrlName)));
+    }
 
     SimpleRenderer* nominatimRenderer = new SimpleRenderer(this);
     SimpleFillSymbol* nominatimFillSymbol = new SimpleFillSymbol(SimpleFillSymbolStyle::Solid, QColor("#d3c2a6"), this);
@@ -65,6 +121,75 @@ NominatimPlaceLayer::NominatimPlaceLayer(QObject *parent) :
     m_pointOverlay->setRenderer(nominatimPointRenderer);
 }
 
+void NominatimPlaceLayer::setResponseCache(ResponseCache *responseCache)
+{
+    m_responseCache = responseCache;
+    m_geocodeCache.setTimeToLive(responseCache->timeToLive("nominatim"));
+}
+
+void NominatimPlaceLayer::setSuggestionUrl(const QUrl &suggestionUrl)
+{
+    m_suggestionUrl = suggestionUrl;
+}
+
+QUrl NominatimPlaceLayer::suggestionUrl() const
+{
+    return m_suggestionUrl;
+}
+
+void NominatimPlaceLayer::loadGazetteer(const QString &extractDirectory)
+{
+    // GeoNames extracts like cities500.txt or DE.txt
+    QDir extractDir(extractDirectory);
+    QFileInfoList extractFileInfos = extractDir.entryInfoList(QStringList() << "*.txt", QDir::Files, QDir::Name);
+    if (extractFileInfos.isEmpty())
+    {
+        return;
+    }
+
+    // The index is only built again when an extract changed
+    QStringList extractFilePaths;
+    QStringList extractValidators;
+    foreach (const QFileInfo& extractFileInfo, extractFileInfos)
+    {
+        extractFilePaths.append(extractFileInfo.absoluteFilePath());
+        extractValidators.append(GeoJsonBinaryCache::fileValidator(extractFileInfo.absoluteFilePath()));
+    }
+    QString indexKey = QCryptographicHash::hash(extractValidators.join('|').toUtf8(), QCryptographicHash::Sha1).toHex();
+    QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QDir indexDir(QDir(cacheLocation).filePath("gazetteer"));
+    indexDir.mkpath(".");
+    QString indexFilePath = indexDir.filePath(indexKey + ".gzix");
+    if (m_gazetteer.open(indexFilePath))
+    {
+        return;
+    }
+
+    // The index is built on the worker pool, the indexes of older extracts are removed afterwards
+    QFutureWatcher<bool>* buildWatcher = new QFutureWatcher<bool>(this);
+    connect(buildWatcher, &QFutureWatcherBase::finished, this, [this, buildWatcher, indexDir, indexFilePath]()
+    {
+        buildWatcher->deleteLater();
+        if (!buildWatcher->result() || !m_gazetteer.open(indexFilePath))
+        {
+            return;
+        }
+
+        QFileInfoList indexFileInfos = indexDir.entryInfoList(QStringList() << "*.gzix", QDir::Files);
+        foreach (const QFileInfo& indexFileInfo, indexFileInfos)
+        {
+            if (indexFileInfo.absoluteFilePath() != QFileInfo(indexFilePath).absoluteFilePath())
+            {
+                QFile::remove(indexFileInfo.absoluteFilePath());
+            }
+        }
+    });
+    buildWatcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(), [extractFilePaths, indexFilePath]()
+    {
+        return GazetteerIndex::build(extractFilePaths, indexFilePath);
+    }));
+}
+
 GraphicsOverlay* NominatimPlaceLayer::overlay() const
 {
     return m_overlay;
@@ -75,6 +200,11 @@ GraphicsOverlay* NominatimPlaceLayer::pointOverlay() const
     return m_pointOverlay;
 }
 
+Graphic* NominatimPlaceLayer::findGraphic(const QString &graphicUid) const
+{
+    return m_graphicsByUid.value(graphicUid, nullptr);
+}
+
 void NominatimPlaceLayer::setQueryFilter(const QString &filter)
 {
     m_queryFilter = filter;
@@ -87,103 +217,522 @@ void NominatimPlaceLayer::query()
         return;
     }
 
-    QString nominatimQueryString = "https://nominatim.openstreetmap.org/search?q="
-        + m_queryFilter
-        + "&format=geojson&polygon_geojson=1";
+    supersedeQuery();
+    startLookup(m_queryFilter, false);
+}
+
+void NominatimPlaceLayer::supersedeQuery()
+{
+    // A new query supersedes the pending one, batch lookups continue
+    m_parsePipeline->supersede();
+    QList<QNetworkRequest> canceledRequests = m_scheduler->cancel(RequestScheduler::HighPriority);
+    foreach (const QNetworkRequest& canceledRequest, canceledRequests)
+    {
+        // Batch requests raised to the priority of an identical query stay pending
+        int lookupId = canceledRequest.attribute(LookupIdAttribute).toInt();
+        if (m_pendingLookups.value(lookupId).batch)
+        {
+            m_scheduler->enqueue(canceledRequest, RequestScheduler::LowPriority);
+        }
+    }
+    for (auto lookupIterator = m_pendingLookups.begin(); lookupIterator != m_pendingLookups.end();)
+    {
+        if (lookupIterator.value().batch)
+        {
+            ++lookupIterator;
+        }
+        else
+        {
+            lookupIterator = m_pendingLookups.erase(lookupIterator);
+        }
+    }
+}
+
+void NominatimPlaceLayer::queryBatch(const QStringList &placeNames)
+{
+    // Identical places are only looked up once
+    QStringList batchPlaceNames;
+    foreach (const QString& placeName, placeNames)
+    {
+        QString normalizedQuery = GeocodeCache::normalizedQuery(placeName);
+        if (normalizedQuery.isEmpty() || m_batchQueries.contains(normalizedQuery))
+        {
+            continue;
+        }
+        m_batchQueries.insert(normalizedQuery);
+        batchPlaceNames.append(placeName.trimmed());
+    }
+
+    if (batchPlaceNames.isEmpty())
+    {
+        return;
+    }
+
+    // Places resolve as fast as the usage policy permits and show up one by one
+    m_batchPlaceCount += batchPlaceNames.count();
+    emit batchProgress(m_batchResolvedCount, m_batchPlaceCount);
+    foreach (const QString& placeName, batchPlaceNames)
+    {
+        startLookup(placeName, true);
+    }
+}
+
+void NominatimPlaceLayer::startLookup(const QString &queryText, bool batch, const QString &osmId)
+{
+    // Places chosen from the suggestions are looked up by their OSM id
+    PendingLookup lookup;
+    lookup.normalizedQuery = GeocodeCache::normalizedQuery(osmId.isEmpty() ? queryText : "osm " + osmId);
+    lookup.batch = batch;
+
+    // Repeated lookups append the parsed features of the cache
+    ParsedFeatureList cachedFeatures;
+    if (m_geocodeCache.lookup(lookup.normalizedQuery, cachedFeatures))
+    {
+        resolveLookup(lookup, cachedFeatures);
+        return;
+    }
+
+    FeatureParsePipeline* parsePipeline = batch ? m_batchPipeline : m_parsePipeline;
+    quint64 generation = parsePipeline->generation();
+    int lookupId = m_nextLookupId++;
+    bool cacheOnly = m_responseCache && m_responseCache->isCacheOnly();
+    GeoJsonBinaryCache::Source cachedSource = m_geocodeCache.open(lookup.normalizedQuery, cacheOnly);
+    if (cachedSource.isValid())
+    {
+        m_pendingLookups.insert(lookupId, lookup);
+        parsePipeline->submit(generation, [cachedSource](const CancelCheck& isCanceled)
+        {
+            Q_UNUSED(isCanceled);
+            ParsedFeatureList sourceFeatures = cachedSource.readFeatures(0, cachedSource.featureCount());
+            GeocodeCache::sortByImportance(sourceFeatures);
+            return sourceFeatures;
+        }, lookupId);
+        return;
+    }
+
+    // Exact names of the offline gazetteer are answered locally, Nominatim is asked for all other names
+    ParsedFeatureList gazetteerFeatures;
+    if (osmId.isEmpty())
+    {
+        gazetteerFeatures = m_gazetteer.lookup(lookup.normalizedQuery, MaximumGazetteerPlaceCount);
+    }
+    if (!gazetteerFeatures.isEmpty())
+    {
+        resolveLookup(lookup, gazetteerFeatures);
+        return;
+    }
+
+    if (cacheOnly)
+    {
+        qDebug() << "Nominatim query is not cached!" << queryText;
+        resolveLookup(lookup, ParsedFeatureList());
+        return;
+    }
+
+    QString nominatimQueryString = osmId.isEmpty()
+        ? "https://nominatim.openstreetmap.org/search?q=" + queryText + "&format=geojson&polygon_geojson=1"
+        : "https://nominatim.openstreetmap.org/lookup?osm_ids=" + osmId + "&format=geojson&polygon_geojson=1";
     //qDebug() << nominatimQueryString;
 
+    QUrl nominatimQueryUrl(nominatimQueryString);
+
     QNetworkRequest nominatimRequest;
-    nominatimRequest.setUrl(nominatimQueryString);
-    m_networkAccessManager->get(nominatimRequest);
+    nominatimRequest.setUrl(nominatimQueryUrl);
+    nominatimRequest.setAttribute(LookupIdAttribute, lookupId);
+    parsePipeline->trackRequest(nominatimRequest, generation);
+
+    // Identical pending requests resolve the lookup of the first one
+    lookup.persist = true;
+    if (m_scheduler->enqueue(nominatimRequest, batch ? RequestScheduler::LowPriority : RequestScheduler::HighPriority))
+    {
+        m_pendingLookups.insert(lookupId, lookup);
+    }
 }
 
-void NominatimPlaceLayer::networkRequestFinished(QNetworkReply *reply)
+void NominatimPlaceLayer::suggest(const QString &text)
 {
-    if (reply->error())
+    // Suggestions start after a pause in typing, the pending ones are superseded right away
+    m_suggestionText = text;
+    cancelSuggestions();
+    m_suggestionTimer->start();
+}
+
+void NominatimPlaceLayer::querySuggestion(const QVariantMap &suggestion)
+{
+    cancelSuggestions();
+    supersedeQuery();
+
+    // Only the chosen place gets its full geometry
+    QString source = suggestion.value("source").toString();
+    if ("gazetteer" == source)
     {
-        qDebug() << reply->errorString();
+        ParsedFeature place = m_gazetteer.place(suggestion.value("placeId").toUInt());
+        if (!place.geometry.isEmpty())
+        {
+            appendFeatures(ParsedFeatureList() << place);
+        }
+    }
+    else if ("nominatim" == source)
+    {
+        startLookup(suggestion.value("displayName").toString(), false, suggestion.value("osmId").toString());
+    }
+    else
+    {
+        startLookup(suggestion.value("query").toString(), false);
+    }
+}
+
+void NominatimPlaceLayer::startSuggestions()
+{
+    QString normalizedPrefix = GeocodeCache::normalizedQuery(m_suggestionText);
+    if (normalizedPrefix.length() < MinimumSuggestionLength)
+    {
+        emit suggestionsChanged(QVariantList());
         return;
     }
 
-    QByteArray jsonResponse = reply->readAll();
-    QJsonDocument nominatimPlacesDocument = QJsonDocument::fromJson(jsonResponse);
-    if (nominatimPlacesDocument.isNull())
+    // Cached results and gazetteer places are suggested right away
+    QVariantList suggestions;
+    QStringList cachedQueries = m_geocodeCache.completions(normalizedPrefix, MaximumSuggestionCount);
+    foreach (const QString& cachedQuery, cachedQueries)
     {
-        qDebug() << "JSON is invalid!";
+        ParsedFeatureList cachedFeatures;
+        m_geocodeCache.lookup(cachedQuery, cachedFeatures);
+        QVariantMap suggestion;
+        suggestion.insert("displayName", cachedFeatures.isEmpty() ? cachedQuery : cachedFeatures.first().attributes.value("display_name").toString());
+        suggestion.insert("query", cachedQuery);
+        suggestion.insert("source", "cache");
+        suggestions.append(suggestion);
+    }
+
+    QList<quint32> placeIds = m_gazetteer.complete(normalizedPrefix, MaximumSuggestionCount - suggestions.count());
+    foreach (quint32 placeId, placeIds)
+    {
+        suggestions.append(gazetteerSuggestion(m_gazetteer, placeId));
+    }
+
+    if (suggestions.count() < MaximumSuggestionCount && m_gazetteer.isValid())
+    {
+        // Misspelled names take too long for the GUI thread, they are searched on the worker pool
+        quint64 suggestionGeneration = m_suggestionGeneration;
+        GazetteerIndex gazetteer = m_gazetteer;
+        int similarCount = MaximumSuggestionCount - suggestions.count();
+        QFutureWatcher<QList<quint32>>* similarWatcher = new QFutureWatcher<QList<quint32>>(this);
+        connect(similarWatcher, &QFutureWatcherBase::finished, this, [this, similarWatcher, suggestionGeneration, gazetteer, placeIds, suggestions]()
+        {
+            similarWatcher->deleteLater();
+            if (suggestionGeneration != m_suggestionGeneration)
+            {
+                // Superseded by a newer text
+                return;
+            }
+
+            QVariantList allSuggestions = suggestions;
+            foreach (quint32 placeId, similarWatcher->result())
+            {
+                if (!placeIds.contains(placeId))
+                {
+                    allSuggestions.append(gazetteerSuggestion(gazetteer, placeId));
+                }
+            }
+            finishSuggestions(allSuggestions);
+        });
+        similarWatcher->setFuture(QtConcurrent::run(QThreadPool::globalInstance(), [gazetteer, normalizedPrefix, similarCount]()
+        {
+            return gazetteer.similar(normalizedPrefix, similarCount);
+        }));
+        return;
+    }
+
+    finishSuggestions(suggestions);
+}
+
+QVariantMap NominatimPlaceLayer::gazetteerSuggestion(const GazetteerIndex &gazetteer, quint32 placeId)
+{
+    QVariantMap suggestion;
+    suggestion.insert("displayName", gazetteer.place(placeId).attributes.value("display_name"));
+    suggestion.insert("placeId", placeId);
+    suggestion.insert("source", "gazetteer");
+    return suggestion;
+}
+
+void NominatimPlaceLayer::finishSuggestions(const QVariantList &suggestions)
+{
+    bool cacheOnly = m_responseCache && m_responseCache->isCacheOnly();
+
+    // The usage policy of the public Nominatim forbids autocompletion, only an own server is asked
+    if (m_suggestionUrl.isEmpty() || !suggestions.isEmpty() || cacheOnly)
+    {
+        emit suggestionsChanged(suggestions);
         return;
     }
-    if (!nominatimPlacesDocument.isObject())
+
+    // The suggestion server suggests places without their geometry, the chosen one is looked up by its OSM id
+    QUrlQuery suggestionQuery(m_suggestionUrl);
+    suggestionQuery.addQueryItem("q", m_suggestionText.trimmed());
+    suggestionQuery.addQueryItem("limit", QString::number(MaximumSuggestionCount));
+    QUrl suggestionUrl(m_suggestionUrl);
+    suggestionUrl.setQuery(suggestionQuery);
+
+    QNetworkRequest suggestionRequest(suggestionUrl);
+    suggestionRequest.setAttribute(SuggestionAttribute, ++m_suggestionGeneration);
+    m_suggestionReply = m_networkAccessManager->get(suggestionRequest);
+}
+
+void NominatimPlaceLayer::cancelSuggestions()
+{
+    // Superseded suggestions are dropped, their request is aborted while loading
+    m_suggestionTimer->stop();
+    m_suggestionGeneration++;
+    if (m_suggestionReply)
+    {
+        m_suggestionReply->abort();
+        m_suggestionReply = nullptr;
+    }
+}
+
+void NominatimPlaceLayer::suggestionsReceived(QNetworkReply *reply)
+{
+    if (m_suggestionGeneration != reply->request().attribute(SuggestionAttribute).toULongLong())
     {
-        qDebug() << "JSON document is not an object!";
+        // Superseded by a newer text
         return;
     }
 
-    QJsonObject nominatimPlacesObject = nominatimPlacesDocument.object();
-    QJsonArray nominatimFeaturesArray = nominatimPlacesObject["features"].toArray();
-    foreach(const QJsonValue& featureValue, nominatimFeaturesArray)
+    m_suggestionReply = nullptr;
+    if (reply->error())
     {
-        if (featureValue.isObject())
+        qDebug() << reply->errorString();
+        return;
+    }
+
+    // Nominatim answers with an array of places, Photon with a feature collection
+    QJsonDocument suggestionDocument = QJsonDocument::fromJson(reply->readAll());
+    QJsonArray places = suggestionDocument.array();
+    if (suggestionDocument.isObject())
+    {
+        places = QJsonArray();
+        QJsonArray features = suggestionDocument.object().value("features").toArray();
+        foreach (const QJsonValue& featureValue, features)
         {
-            QJsonObject geojsonFeature = featureValue.toObject();
-            QJsonObject geojsonFeatureGeometry = geojsonFeature["geometry"].toObject();
-            QJsonValue geometryTypeValue = geojsonFeatureGeometry["type"];
-            if (geometryTypeValue.isString())
+            QJsonObject properties = featureValue.toObject().value("properties").toObject();
+            QStringList nameParts;
+            foreach (const QString& key, QStringList() << "name" << "city" << "state" << "country")
             {
-                QJsonValue coordinatesValue = geojsonFeatureGeometry["coordinates"];
-                if (coordinatesValue.isArray())
+                QString namePart = properties.value(key).toString();
+                if (!namePart.isEmpty() && !nameParts.contains(namePart))
                 {
-                    QJsonObject properties = geojsonFeature["properties"].toObject();
-                    QVariantMap propertyMap = properties.toVariantMap();
-
-                    QJsonArray coordinatesArray = coordinatesValue.toArray();
-                    QString geometryType = geometryTypeValue.toString();
-                    if (0 == QString::compare("Point", geometryType))
-                    {
-                        if (1 < coordinatesArray.count())
-                        {
-                            double x = coordinatesArray[0].toDouble();
-                            double y = coordinatesArray[1].toDouble();
-                            Point location(x, y, SpatialReference::wgs84());
-                            Graphic* geojsonGraphic = new Graphic(location, propertyMap, this);
-                            QUuid uniqueId = QUuid::createUuid();
-                            geojsonGraphic->attributes()->insertAttribute("uid", uniqueId.toString());
-                            m_pointOverlay->graphics()->append(geojsonGraphic);
-                        }
-                    }
-                    else if (0 == QString::compare("Polygon", geometryType))
-                    {
-                        PolygonBuilder polygonBuilder(SpatialReference::wgs84());
-                        foreach (const QJsonValue& ringValue, coordinatesArray)
-                        {
-                            if (ringValue.isArray())
-                            {
-                                QJsonArray ringsArray = ringValue.toArray();
-                                foreach (const QJsonValue& verticesValue, ringsArray)
-                                {
-                                    if (verticesValue.isArray())
-                                    {
-                                        QJsonArray verticesArray = verticesValue.toArray();
-                                        if (1 < verticesArray.count())
-                                        {
-                                            double x = verticesArray[0].toDouble();
-                                            double y = verticesArray[1].toDouble();
-                                            polygonBuilder.addPoint(x, y);
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        Polygon polygon = polygonBuilder.toPolygon();
-                        Graphic* geojsonGraphic = new Graphic(polygon, propertyMap, this);
-                        QUuid uniqueId = QUuid::createUuid();
-                        geojsonGraphic->attributes()->insertAttribute("uid", uniqueId.toString());
-                        m_overlay->graphics()->append(geojsonGraphic);
-                    }
+                    nameParts.append(namePart);
                 }
             }
+            properties.insert("display_name", nameParts.join(", "));
+            places.append(properties);
+        }
+    }
+
+    // The OSM type and id identify the place when it is chosen
+    QVariantList suggestions;
+    foreach (const QJsonValue& placeValue, places)
+    {
+        QJsonObject place = placeValue.toObject();
+        QString osmType = place.value("osm_type").toString();
+        qint64 osmId = qint64(place.value("osm_id").toDouble());
+        if (osmType.isEmpty() || 0 == osmId)
+        {
+            continue;
         }
+
+        QVariantMap suggestion;
+        suggestion.insert("displayName", place.value("display_name").toString());
+        suggestion.insert("osmId", osmType.left(1).toUpper() + QString::number(osmId));
+        suggestion.insert("source", "nominatim");
+        suggestions.append(suggestion);
+    }
+    emit suggestionsChanged(suggestions);
+}
+
+void NominatimPlaceLayer::resolveLookup(const NominatimPlaceLayer::PendingLookup &lookup, const ParsedFeatureList &features)
+{
+    // Batch places already resolved by an interactive lookup are not appended twice
+    bool batchResolved = m_batchQueries.remove(lookup.normalizedQuery);
+    if (lookup.batch && !batchResolved)
+    {
+        return;
+    }
+
+    appendFeatures(features);
+
+    if (batchResolved)
+    {
+        m_batchResolvedCount++;
+        emit batchProgress(m_batchResolvedCount, m_batchPlaceCount);
+        if (m_batchQueries.isEmpty())
+        {
+            m_batchResolvedCount = 0;
+            m_batchPlaceCount = 0;
+        }
+    }
+}
+
+void NominatimPlaceLayer::setResolution(double degreesPerPixel)
+{
+    m_geometryPyramid.setResolution(degreesPerPixel);
+}
+
+void NominatimPlaceLayer::requestSent(QNetworkReply *reply)
+{
+    // Superseded requests are aborted while loading
+    int lookupId = reply->request().attribute(LookupIdAttribute).toInt();
+    bool batch = m_pendingLookups.value(lookupId).batch;
+    FeatureParsePipeline* parsePipeline = batch ? m_batchPipeline : m_parsePipeline;
+    parsePipeline->trackReply(reply);
+}
+
+void NominatimPlaceLayer::networkRequestFinished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (reply->request().attribute(SuggestionAttribute).isValid())
+    {
+        suggestionsReceived(reply);
+        return;
+    }
+
+    int lookupId = reply->request().attribute(LookupIdAttribute).toInt();
+    auto lookupIterator = m_pendingLookups.find(lookupId);
+    if (lookupIterator == m_pendingLookups.end())
+    {
+        // Superseded by a newer query
+        return;
+    }
+
+    PendingLookup lookup = lookupIterator.value();
+    FeatureParsePipeline* parsePipeline = lookup.batch ? m_batchPipeline : m_parsePipeline;
+    quint64 generation = FeatureParsePipeline::requestGeneration(reply);
+    if (!parsePipeline->isCurrent(generation))
+    {
+        m_pendingLookups.erase(lookupIterator);
+        return;
+    }
+
+    // Throttled requests are sent again once the server is ready, all other requests wait as well
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool throttled = 429 == statusCode || 503 == statusCode;
+    if (throttled && ++lookupIterator->attemptCount < MaximumAttemptCount)
+    {
+        int delay = RequestScheduler::retryDelay(reply->rawHeader("Retry-After"), lookupIterator->attemptCount);
+        qDebug() << "Nominatim request was throttled, sending it again in" << delay << "ms.";
+        m_scheduler->holdFor(delay);
+        if (!m_scheduler->enqueue(reply->request(), lookup.batch ? RequestScheduler::LowPriority : RequestScheduler::HighPriority))
+        {
+            // An identical pending request resolves the place
+            m_pendingLookups.erase(lookupIterator);
+        }
+        return;
+    }
+
+    if (throttled || reply->error())
+    {
+        qDebug() << reply->errorString();
+        m_pendingLookups.erase(lookupIterator);
+        if (lookup.batch)
+        {
+            resolveLookup(lookup, ParsedFeatureList());
+        }
+        return;
+    }
+
+    parseResponse(parsePipeline, generation, lookupId, reply->readAll());
+}
+
+void NominatimPlaceLayer::parseResponse(FeatureParsePipeline* parsePipeline, quint64 generation, int lookupId, const QByteArray &jsonResponse)
+{
+    parsePipeline->submit(generation, [jsonResponse](const CancelCheck& isCanceled)
+    {
+        return GraphicsFactory::parseFeatureCollection(jsonResponse, isCanceled);
+    }, lookupId);
+}
+
+void NominatimPlaceLayer::featuresParsed(quint64 generation, const ParsedFeatureList &features, int lookupId)
+{
+    Q_UNUSED(generation);
+    if (!m_pendingLookups.contains(lookupId))
+    {
+        return;
+    }
+
+    // Downloaded results are persisted, results read from their binary copy are kept in memory
+    PendingLookup lookup = m_pendingLookups.take(lookupId);
+    m_geocodeCache.insert(lookup.normalizedQuery, features, lookup.persist);
+    resolveLookup(lookup, features);
+}
+
+void NominatimPlaceLayer::appendFeatures(const ParsedFeatureList &features)
+{
+    QList<Graphic*> pointGraphics;
+    QList<Graphic*> areaGraphics;
+    foreach (const ParsedFeature& feature, features)
+    {
+        QList<Graphic*>* targetGraphics = nullptr;
+        switch (feature.geometry.geometryType())
+        {
+        case GeometryType::Point:
+            targetGraphics = &pointGraphics;
+            break;
+
+        case GeometryType::Polygon:
+            targetGraphics = &areaGraphics;
+            break;
+
+        default:
+            continue;
+        }
+
+        Graphic* geojsonGraphic = new Graphic(feature.geometry, feature.attributes, this);
+        QString uniqueId = QUuid::createUuid().toString();
+        geojsonGraphic->attributes()->insertAttribute("uid", uniqueId);
+        m_graphicsByUid.insert(uniqueId, geojsonGraphic);
+        m_geometryPyramid.insert(geojsonGraphic, feature.geometry, feature.levels);
+        targetGraphics->append(geojsonGraphic);
+    }
+
+    if (!pointGraphics.isEmpty())
+    {
+        m_pointOverlay->graphics()->append(pointGraphics);
+    }
+    if (!areaGraphics.isEmpty())
+    {
+        m_overlay->graphics()->append(areaGraphics);
     }
 
     emit queryFinished();
 }
+
+void NominatimPlaceLayer::clear(GraphicsOverlay *overlay)
+{
+    GraphicListModel* graphics = overlay->graphics();
+    int graphicCount = graphics->size();
+    for (int graphicIndex = 0; graphicIndex < graphicCount; graphicIndex++)
+    {
+        Graphic* graphic = graphics->at(graphicIndex);
+        QString uniqueId = graphic->attributes()->attributeValue("uid").toString();
+        m_graphicsByUid.remove(uniqueId);
+        m_geometryPyramid.remove(graphic);
+    }
+    graphics->clear();
+}
+
+bool NominatimPlaceLayer::removeSelectedGraphics(GraphicsOverlay *overlay)
+{
+    bool removedGraphic = false;
+    QList<Graphic*> selectedGraphics = overlay->selectedGraphics();
+    foreach (Graphic* selectedGraphic, selectedGraphics)
+    {
+        QString uniqueId = selectedGraphic->attributes()->attributeValue("uid").toString();
+        m_graphicsByUid.remove(uniqueId);
+        m_geometryPyramid.remove(selectedGraphic);
+        overlay->graphics()->removeOne(selectedGraphic);
+        removedGraphic = true;
+    }
+
+    return removedGraphic;
+}
@@ -24,6 +24,11 @@
 #ifndef NOMINATIMPLACELAYER_H
 #define NOMINATIMPLACELAYER_H
 
+#include "GazetteerIndex.h"
+#include "GeocodeCache.h"
+#include "GeometryPyramid.h"
+#include "ParsedFeature.h"
+
 namespace Esri
 {
 namespace ArcGISRuntime
@@ -35,10 +40,19 @@ class Renderer;
 }
 }
 
+class FeatureParsePipeline;
+class RequestScheduler;
+class ResponseCache;
 class QNetworkReply;
+class QTimer;
 
+#include <QHash>
 #include <QNetworkAccessManager>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QUrl>
+#include <QVariantList>
 
 class NominatimPlaceLayer : public QObject
 {
@@ -46,27 +60,109 @@ class NominatimPlaceLayer : public QObject
 public:
     explicit NominatimPlaceLayer(QObject *parent = nullptr);
 
+    void setResponseCache(ResponseCache* responseCache);
+
+    void loadGazetteer(const QString& extractDirectory);
+
+    void setSuggestionUrl(const QUrl& suggestionUrl);
+    QUrl suggestionUrl() const;
+
     Esri::ArcGISRuntime::GraphicsOverlay* overlay() const;
     Esri::ArcGISRuntime::GraphicsOverlay* pointOverlay() const;
 
+    Esri::ArcGISRuntime::Graphic* findGraphic(const QString& graphicUid) const;
+
     void setQueryFilter(const QString& filter);
 
     void query();
 
+    void queryBatch(const QStringList& placeNames);
+
+    void suggest(const QString& text);
+
+    void querySuggestion(const QVariantMap& suggestion);
+
+    void setResolution(double degreesPerPixel);
+
+    void clear(Esri::ArcGISRuntime::GraphicsOverlay* overlay);
+
+    bool removeSelectedGraphics(Esri::ArcGISRuntime::GraphicsOverlay* overlay);
+
 signals:
     void queryFinished();
+    void batchProgress(int resolvedCount, int placeCount);
+    void suggestionsChanged(const QVariantList& suggestions);
 
 private slots:
+    void requestSent(QNetworkReply* reply);
     void networkRequestFinished(QNetworkReply* reply);
+    void featuresParsed(quint64 generation, const ParsedFeatureList& features, int lookupId);
+    void startSuggestions();
 
 private:
+    struct PendingLookup
+    {
+        QString normalizedQuery;
+        bool persist = false;
+        bool batch = false;
+        int attemptCount = 0;
+    };
+
+    void supersedeQuery();
+
+    void startLookup(const QString& queryText, bool batch, const QString& osmId = QString());
+
+    void resolveLookup(const PendingLookup& lookup, const ParsedFeatureList& features);
+
+    void finishSuggestions(const QVariantList& suggestions);
+
+    static QVariantMap gazetteerSuggestion(const GazetteerIndex& gazetteer, quint32 placeId);
+
+    void cancelSuggestions();
+
+    void suggestionsReceived(QNetworkReply* reply);
+
+    void parseResponse(FeatureParsePipeline* parsePipeline, quint64 generation, int lookupId, const QByteArray& jsonResponse);
+
+    void appendFeatures(const ParsedFeatureList& features);
+
     QNetworkAccessManager* m_networkAccessManager = nullptr;
+    RequestScheduler* m_scheduler = nullptr;
+    FeatureParsePipeline* m_parsePipeline = nullptr;
+    FeatureParsePipeline* m_batchPipeline = nullptr;
+    ResponseCache* m_responseCache = nullptr;
     QString m_wikimapiaLicenseKey;
 
     Esri::ArcGISRuntime::GraphicsOverlay* m_overlay = nullptr;
     Esri::ArcGISRuntime::GraphicsOverlay* m_pointOverlay = nullptr;
 
     QString m_queryFilter;
+
+    // Parsed results by their normalized query, and the lookups being resolved by their id
+    GeocodeCache m_geocodeCache;
+    QHash<int, PendingLookup> m_pendingLookups;
+    int m_nextLookupId = 1;
+
+    // Places answered locally before asking Nominatim
+    GazetteerIndex m_gazetteer;
+
+    // Normalized queries of the batch places not resolved yet
+    QSet<QString> m_batchQueries;
+    int m_batchResolvedCount = 0;
+    int m_batchPlaceCount = 0;
+
+    // Keystrokes are debounced, only the suggestions of the latest text are shown
+    QTimer* m_suggestionTimer = nullptr;
+    QString m_suggestionText;
+    quint64 m_suggestionGeneration = 0;
+    QPointer<QNetworkReply> m_suggestionReply;
+
+    // Search endpoint of an own Nominatim or Photon server, no remote suggestions without one
+    QUrl m_suggestionUrl;
+
+    // Graphics of both overlays by their unique id
+    QHash<QString, Esri::ArcGISRuntime::Graphic*> m_graphicsByUid;
+    GeometryPyramid m_geometryPyramid;
 };
 
 #endif // NOMINATIMPLACELAYER_H
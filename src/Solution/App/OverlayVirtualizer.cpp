@@ -0,0 +1,312 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "OverlayVirtualizer.h"
+
+#include "Graphic.h"
+#include "GraphicsOverlay.h"
+
+#include <cmath>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace
+{
+// Graphics around the visible extent are kept, so that small pans do not recreate them
+const double ExtentMargin = 0.5;
+
+// Items covering more cells are not binned
+const qint64 MaxItemCellCount = 256;
+}
+
+OverlayVirtualizer::OverlayVirtualizer(GraphicsOverlay *overlay, double cellSize, const GraphicFactory &createGraphic) :
+    m_overlay(overlay),
+    m_cellSize(cellSize),
+    m_createGraphic(createGraphic)
+{
+}
+
+void OverlayVirtualizer::insert(qint64 itemId, const QRectF &extent)
+{
+    remove(itemId);
+    m_extents.insert(itemId, extent);
+
+    CellRange itemCells = cellRange(extent);
+    qint64 itemCellCount = (itemCells.lastColumn - itemCells.firstColumn + 1) * (itemCells.lastRow - itemCells.firstRow + 1);
+    if (MaxItemCellCount < itemCellCount)
+    {
+        m_largeItemIds.insert(itemId);
+    }
+    else
+    {
+        for (qint64 column = itemCells.firstColumn; column <= itemCells.lastColumn; column++)
+        {
+            for (qint64 row = itemCells.firstRow; row <= itemCells.lastRow; row++)
+            {
+                m_cells[cellKey(column, row)].append(itemId);
+            }
+        }
+    }
+
+    if (m_materializedExtent.isNull() || intersects(extent, m_materializedExtent))
+    {
+        materialize(itemId);
+    }
+}
+
+void OverlayVirtualizer::remove(qint64 itemId)
+{
+    auto extentIterator = m_extents.find(itemId);
+    if (extentIterator == m_extents.end())
+    {
+        return;
+    }
+
+    if (!m_largeItemIds.remove(itemId))
+    {
+        CellRange itemCells = cellRange(extentIterator.value());
+        for (qint64 column = itemCells.firstColumn; column <= itemCells.lastColumn; column++)
+        {
+            for (qint64 row = itemCells.firstRow; row <= itemCells.lastRow; row++)
+            {
+                quint64 key = cellKey(column, row);
+                auto cellIterator = m_cells.find(key);
+                if (cellIterator != m_cells.end())
+                {
+                    cellIterator->removeOne(itemId);
+                    if (cellIterator->isEmpty())
+                    {
+                        m_cells.erase(cellIterator);
+                    }
+                }
+            }
+        }
+    }
+    m_extents.erase(extentIterator);
+
+    Graphic* itemGraphic = m_graphics.take(itemId);
+    if (nullptr != itemGraphic)
+    {
+        if (!m_pendingGraphics.removeOne(itemGraphic))
+        {
+            m_overlay->graphics()->removeOne(itemGraphic);
+        }
+        delete itemGraphic;
+    }
+}
+
+bool OverlayVirtualizer::contains(qint64 itemId) const
+{
+    return m_extents.contains(itemId);
+}
+
+void OverlayVirtualizer::clear()
+{
+    m_overlay->graphics()->clear();
+    qDeleteAll(m_graphics);
+    m_graphics.clear();
+    m_pendingGraphics.clear();
+    m_extents.clear();
+    m_cells.clear();
+    m_largeItemIds.clear();
+}
+
+int OverlayVirtualizer::count() const
+{
+    return m_extents.count();
+}
+
+void OverlayVirtualizer::setVisibleExtent(const QRectF &visibleExtent)
+{
+    commit();
+    if (visibleExtent.isNull())
+    {
+        m_materializedExtent = QRectF();
+    }
+    else
+    {
+        double marginX = ExtentMargin * visibleExtent.width();
+        double marginY = ExtentMargin * visibleExtent.height();
+        m_materializedExtent = visibleExtent.normalized().adjusted(-marginX, -marginY, marginX, marginY);
+    }
+    QSet<qint64> visibleItemIds = itemsWithin(m_materializedExtent);
+
+    // Graphics leaving the extent are deleted
+    QList<Graphic*> droppedGraphics;
+    for (auto graphicIterator = m_graphics.begin(); graphicIterator != m_graphics.end();)
+    {
+        if (visibleItemIds.contains(graphicIterator.key()))
+        {
+            ++graphicIterator;
+        }
+        else
+        {
+            droppedGraphics.append(graphicIterator.value());
+            graphicIterator = m_graphics.erase(graphicIterator);
+        }
+    }
+
+    if (!droppedGraphics.isEmpty())
+    {
+        // Rebuilding the overlay is cheaper than removing most of its graphics one by one
+        if (m_graphics.count() < droppedGraphics.count())
+        {
+            m_overlay->graphics()->clear();
+            QList<Graphic*> keptGraphics = m_graphics.values();
+            if (!keptGraphics.isEmpty())
+            {
+                m_overlay->graphics()->append(keptGraphics);
+            }
+        }
+        else
+        {
+            foreach (Graphic* droppedGraphic, droppedGraphics)
+            {
+                m_overlay->graphics()->removeOne(droppedGraphic);
+            }
+        }
+        qDeleteAll(droppedGraphics);
+    }
+
+    // Only the items entering the extent are materialized
+    foreach (qint64 itemId, visibleItemIds)
+    {
+        if (!m_graphics.contains(itemId))
+        {
+            materialize(itemId);
+        }
+    }
+    commit();
+}
+
+void OverlayVirtualizer::commit()
+{
+    if (!m_pendingGraphics.isEmpty())
+    {
+        m_overlay->graphics()->append(m_pendingGraphics);
+        m_pendingGraphics.clear();
+    }
+}
+
+Graphic* OverlayVirtualizer::graphic(qint64 itemId) const
+{
+    return m_graphics.value(itemId, nullptr);
+}
+
+int OverlayVirtualizer::graphicCount() const
+{
+    return m_graphics.count();
+}
+
+OverlayVirtualizer::CellRange OverlayVirtualizer::cellRange(const QRectF &extent) const
+{
+    CellRange range;
+    QRectF normalizedExtent = extent.normalized();
+    range.firstColumn = qint64(std::floor(normalizedExtent.left() / m_cellSize));
+    range.lastColumn = qint64(std::floor(normalizedExtent.right() / m_cellSize));
+    range.firstRow = qint64(std::floor(normalizedExtent.top() / m_cellSize));
+    range.lastRow = qint64(std::floor(normalizedExtent.bottom() / m_cellSize));
+    return range;
+}
+
+QSet<qint64> OverlayVirtualizer::itemsWithin(const QRectF &extent) const
+{
+    if (extent.isNull())
+    {
+        return QSet<qint64>::fromList(m_extents.keys());
+    }
+
+    // Small extents visit their cells, large extents visit the occupied cells
+    QSet<qint64> candidateIds = m_largeItemIds;
+    CellRange extentCells = cellRange(extent);
+    qint64 extentCellCount = (extentCells.lastColumn - extentCells.firstColumn + 1) * (extentCells.lastRow - extentCells.firstRow + 1);
+    if (extentCellCount < m_cells.count())
+    {
+        for (qint64 column = extentCells.firstColumn; column <= extentCells.lastColumn; column++)
+        {
+            for (qint64 row = extentCells.firstRow; row <= extentCells.lastRow; row++)
+            {
+                auto cellIterator = m_cells.constFind(cellKey(column, row));
+                if (cellIterator != m_cells.constEnd())
+                {
+                    foreach (qint64 itemId, cellIterator.value())
+                    {
+                        candidateIds.insert(itemId);
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        for (auto cellIterator = m_cells.constBegin(); cellIterator != m_cells.constEnd(); ++cellIterator)
+        {
+            qint64 column = qint32(quint32(cellIterator.key() >> 32));
+            qint64 row = qint32(quint32(cellIterator.key()));
+            if (extentCells.firstColumn <= column && column <= extentCells.lastColumn
+                    && extentCells.firstRow <= row && row <= extentCells.lastRow)
+            {
+                foreach (qint64 itemId, cellIterator.value())
+                {
+                    candidateIds.insert(itemId);
+                }
+            }
+        }
+    }
+
+    QSet<qint64> itemIds;
+    foreach (qint64 itemId, candidateIds)
+    {
+        if (intersects(m_extents.value(itemId), extent))
+        {
+            itemIds.insert(itemId);
+        }
+    }
+    return itemIds;
+}
+
+bool OverlayVirtualizer::materialize(qint64 itemId)
+{
+    Graphic* itemGraphic = m_createGraphic(itemId);
+    if (nullptr == itemGraphic)
+    {
+        return false;
+    }
+
+    m_graphics.insert(itemId, itemGraphic);
+    m_pendingGraphics.append(itemGraphic);
+    return true;
+}
+
+quint64 OverlayVirtualizer::cellKey(qint64 column, qint64 row)
+{
+    return (quint64(quint32(qint32(column))) << 32) | quint64(quint32(qint32(row)));
+}
+
+bool OverlayVirtualizer::intersects(const QRectF &itemExtent, const QRectF &extent)
+{
+    // Points have empty extents, so the bounds are compared inclusively
+    QRectF normalizedItemExtent = itemExtent.normalized();
+    return normalizedItemExtent.left() <= extent.right() && extent.left() <= normalizedItemExtent.right()
+            && normalizedItemExtent.top() <= extent.bottom() && extent.top() <= normalizedItemExtent.bottom();
+}
@@ -0,0 +1,103 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef OVERLAYVIRTUALIZER_H
+#define OVERLAYVIRTUALIZER_H
+
+namespace Esri
+{
+namespace ArcGISRuntime
+{
+class Graphic;
+class GraphicsOverlay;
+}
+}
+
+#include <QHash>
+#include <QList>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
+
+#include <functional>
+
+// Keeps only the graphics of the items within the visible extent plus a margin in an overlay.
+// The extents of all items are binned into the cells of a uniform grid, the graphic of an
+// item is created by the owner when the item enters the extent and deleted when it leaves.
+class OverlayVirtualizer
+{
+public:
+    typedef std::function<Esri::ArcGISRuntime::Graphic*(qint64 itemId)> GraphicFactory;
+
+    OverlayVirtualizer(Esri::ArcGISRuntime::GraphicsOverlay* overlay, double cellSize, const GraphicFactory& createGraphic);
+
+    void insert(qint64 itemId, const QRectF& extent);
+
+    void remove(qint64 itemId);
+
+    bool contains(qint64 itemId) const;
+
+    void clear();
+
+    int count() const;
+
+    void setVisibleExtent(const QRectF& visibleExtent);
+
+    void commit();
+
+    Esri::ArcGISRuntime::Graphic* graphic(qint64 itemId) const;
+
+    int graphicCount() const;
+
+private:
+    struct CellRange
+    {
+        qint64 firstColumn = 0;
+        qint64 lastColumn = -1;
+        qint64 firstRow = 0;
+        qint64 lastRow = -1;
+    };
+
+    CellRange cellRange(const QRectF& extent) const;
+    QSet<qint64> itemsWithin(const QRectF& extent) const;
+    bool materialize(qint64 itemId);
+
+    static quint64 cellKey(qint64 column, qint64 row);
+    static bool intersects(const QRectF& itemExtent, const QRectF& extent);
+
+    Esri::ArcGISRuntime::GraphicsOverlay* m_overlay = nullptr;
+    double m_cellSize = 1;
+    GraphicFactory m_createGraphic;
+
+    // Extents of all items binned by grid cell, items covering many cells are kept apart
+    QHash<qint64, QRectF> m_extents;
+    QHash<quint64, QVector<qint64>> m_cells;
+    QSet<qint64> m_largeItemIds;
+
+    // Graphics of the items within the materialized extent, a null extent materializes every item
+    QHash<qint64, Esri::ArcGISRuntime::Graphic*> m_graphics;
+    QList<Esri::ArcGISRuntime::Graphic*> m_pendingGraphics;
+    QRectF m_materializedExtent;
+};
+
+#endif // OVERLAYVIRTUALIZER_H
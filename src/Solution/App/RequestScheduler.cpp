@@ -0,0 +1,200 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "RequestScheduler.h"
+
+#include "ResponseCache.h"
+
+#include <QDateTime>
+#include <QLocale>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTimer>
+
+#include <cmath>
+
+namespace
+{
+// Delays of throttled requests without a valid Retry-After grow from the initial one
+const int InitialRetryDelay = 2000;
+const int MaximumRetryDelay = 60000;
+}
+
+RequestScheduler::RequestScheduler(QNetworkAccessManager *networkAccessManager, QObject *parent) :
+    QObject(parent),
+    m_networkAccessManager(networkAccessManager),
+    m_sendTimer(new QTimer(this))
+{
+    m_sendTimer->setSingleShot(true);
+    connect(m_sendTimer, &QTimer::timeout, this, &RequestScheduler::sendPending);
+    m_refillTimer.start();
+}
+
+void RequestScheduler::setRate(double requestsPerSecond, int burstSize)
+{
+    refillTokens();
+    m_rate = requestsPerSecond;
+    m_burstSize = qMax(1, burstSize);
+    m_tokens = qMin(m_tokens, double(m_burstSize));
+    sendPending();
+}
+
+double RequestScheduler::rate() const
+{
+    return m_rate;
+}
+
+int RequestScheduler::burstSize() const
+{
+    return m_burstSize;
+}
+
+bool RequestScheduler::enqueue(const QNetworkRequest &request, Priority priority)
+{
+    QString key = requestKey(request);
+    auto pendingPriorityIterator = m_pendingPriorities.find(key);
+    if (pendingPriorityIterator != m_pendingPriorities.end())
+    {
+        // An identical pending request is sent with the higher priority of both
+        int pendingPriority = pendingPriorityIterator.value();
+        if (priority < pendingPriority)
+        {
+            QQueue<QNetworkRequest>& pendingQueue = m_pendingRequests[pendingPriority];
+            for (int requestIndex = 0; requestIndex < pendingQueue.count(); requestIndex++)
+            {
+                if (key == requestKey(pendingQueue.at(requestIndex)))
+                {
+                    m_pendingRequests[priority].enqueue(pendingQueue.takeAt(requestIndex));
+                    break;
+                }
+            }
+            if (pendingQueue.isEmpty())
+            {
+                m_pendingRequests.remove(pendingPriority);
+            }
+            pendingPriorityIterator.value() = priority;
+        }
+        return false;
+    }
+
+    m_pendingRequests[priority].enqueue(request);
+    m_pendingPriorities.insert(key, priority);
+    sendPending();
+    return true;
+}
+
+QList<QNetworkRequest> RequestScheduler::cancel(Priority priority)
+{
+    QQueue<QNetworkRequest> canceledRequests = m_pendingRequests.take(priority);
+    foreach (const QNetworkRequest& canceledRequest, canceledRequests)
+    {
+        m_pendingPriorities.remove(requestKey(canceledRequest));
+    }
+    return canceledRequests;
+}
+
+void RequestScheduler::holdFor(int milliseconds)
+{
+    // A shorter hold never ends a longer one
+    if (m_holdDeadline.remainingTime() < milliseconds)
+    {
+        m_holdDeadline.setRemainingTime(milliseconds);
+    }
+    m_sendTimer->stop();
+    sendPending();
+}
+
+int RequestScheduler::retryDelay(const QByteArray &retryAfter, int attemptCount)
+{
+    // Retry-After holds the seconds to wait or the date to wait for
+    QByteArray trimmedRetryAfter = retryAfter.trimmed();
+    if (!trimmedRetryAfter.isEmpty())
+    {
+        bool validSeconds = false;
+        qint64 seconds = trimmedRetryAfter.toLongLong(&validSeconds);
+        if (validSeconds)
+        {
+            return int(qBound(qint64(0), 1000 * qMin(seconds, qint64(MaximumRetryDelay)), qint64(MaximumRetryDelay)));
+        }
+
+        QDateTime retryTime = QLocale::c().toDateTime(QString::fromLatin1(trimmedRetryAfter), "ddd, dd MMM yyyy HH:mm:ss 'GMT'");
+        if (retryTime.isValid())
+        {
+            retryTime.setTimeSpec(Qt::UTC);
+            return int(qBound(qint64(0), QDateTime::currentDateTimeUtc().msecsTo(retryTime), qint64(MaximumRetryDelay)));
+        }
+    }
+
+    // Exponential backoff
+    return qMin(MaximumRetryDelay, InitialRetryDelay << qBound(0, attemptCount - 1, 16));
+}
+
+int RequestScheduler::pendingCount() const
+{
+    return m_pendingPriorities.count();
+}
+
+void RequestScheduler::sendPending()
+{
+    refillTokens();
+    if (!m_holdDeadline.hasExpired())
+    {
+        if (!m_pendingRequests.isEmpty() && !m_sendTimer->isActive())
+        {
+            m_sendTimer->start(qMax(1, int(m_holdDeadline.remainingTime())));
+        }
+        return;
+    }
+
+    while (1 <= m_tokens && !m_pendingRequests.isEmpty())
+    {
+        auto pendingQueueIterator = m_pendingRequests.begin();
+        QNetworkRequest request = pendingQueueIterator.value().dequeue();
+        if (pendingQueueIterator.value().isEmpty())
+        {
+            m_pendingRequests.erase(pendingQueueIterator);
+        }
+        m_pendingPriorities.remove(requestKey(request));
+
+        m_tokens -= 1;
+        emit requestSent(m_networkAccessManager->get(request));
+    }
+
+    // Wait for the next token
+    if (!m_pendingRequests.isEmpty() && !m_sendTimer->isActive() && 0 < m_rate)
+    {
+        int waitMilliseconds = int(std::ceil(1000 * (1 - m_tokens) / m_rate));
+        m_sendTimer->start(qMax(1, waitMilliseconds));
+    }
+}
+
+void RequestScheduler::refillTokens()
+{
+    qint64 elapsedMilliseconds = m_refillTimer.restart();
+    m_tokens = qMin(double(m_burstSize), m_tokens + m_rate * elapsedMilliseconds / 1000.0);
+}
+
+QString RequestScheduler::requestKey(const QNetworkRequest &request)
+{
+    return ResponseCache::normalizedUrl(request.url());
+}
@@ -0,0 +1,97 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QQueue>
+
+// Sends network requests no faster than a token bucket permits.
+// Pending requests are sent by their priority and then in the order they were enqueued,
+// identical pending requests are only sent once. Sending can be held back for a while,
+// e.g. for the delay a throttling server asks for.
+class RequestScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum Priority
+    {
+        HighPriority = 0,
+        NormalPriority = 1,
+        LowPriority = 2
+    };
+
+    explicit RequestScheduler(QNetworkAccessManager* networkAccessManager, QObject *parent = nullptr);
+
+    void setRate(double requestsPerSecond, int burstSize = 1);
+    double rate() const;
+    int burstSize() const;
+
+    bool enqueue(const QNetworkRequest& request, Priority priority);
+
+    QList<QNetworkRequest> cancel(Priority priority);
+
+    void holdFor(int milliseconds);
+
+    static int retryDelay(const QByteArray& retryAfter, int attemptCount);
+
+    int pendingCount() const;
+
+signals:
+    void requestSent(QNetworkReply* reply);
+
+private:
+    void sendPending();
+
+    void refillTokens();
+
+    static QString requestKey(const QNetworkRequest& request);
+
+    QNetworkAccessManager* m_networkAccessManager = nullptr;
+    QTimer* m_sendTimer = nullptr;
+
+    // Tokens refill with the rate up to the burst size, every request takes one
+    double m_rate = 1;
+    int m_burstSize = 1;
+    double m_tokens = 1;
+    QElapsedTimer m_refillTimer;
+
+    // No request is sent before the deadline, e.g. while the server asks to retry later
+    QDeadlineTimer m_holdDeadline;
+
+    // Pending requests by their priority, and the priorities by the request key
+    QMap<int, QQueue<QNetworkRequest>> m_pendingRequests;
+    QHash<QString, int> m_pendingPriorities;
+};
+
+#endif // REQUESTSCHEDULER_H
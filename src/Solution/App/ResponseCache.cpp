@@ -0,0 +1,232 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "ResponseCache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QUrlQuery>
+
+#include <algorithm>
+
+ResponseCache::ResponseCache(QObject *parent) : QObject(parent)
+{
+    QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    setCacheDirectory(QDir(cacheLocation).filePath("responses"));
+}
+
+void ResponseCache::setCacheDirectory(const QString &cacheDirectory)
+{
+    m_cacheDirectory = cacheDirectory;
+    QDir().mkpath(m_cacheDirectory);
+    loadIndex();
+}
+
+QString ResponseCache::cacheDirectory() const
+{
+    return m_cacheDirectory;
+}
+
+void ResponseCache::setTimeToLive(const QString &source, qint64 seconds)
+{
+    m_timeToLiveBySource.insert(source, seconds);
+}
+
+qint64 ResponseCache::timeToLive(const QString &source) const
+{
+    // Unknown sources are not cached at all
+    return m_timeToLiveBySource.value(source, 0);
+}
+
+void ResponseCache::setMaximumSize(qint64 maximumSize)
+{
+    m_maximumSize = maximumSize;
+    evict();
+}
+
+qint64 ResponseCache::maximumSize() const
+{
+    return m_maximumSize;
+}
+
+void ResponseCache::setCacheOnly(bool cacheOnly)
+{
+    m_cacheOnly = cacheOnly;
+}
+
+bool ResponseCache::isCacheOnly() const
+{
+    return m_cacheOnly;
+}
+
+bool ResponseCache::lookup(const QString &source, const QUrl &url, QByteArray &payload)
+{
+    QString key = cacheKey(source, url);
+    if (!m_entries.contains(key))
+    {
+        return false;
+    }
+
+    QFile cacheFile(filePath(key));
+    QFileInfo cacheFileInfo(cacheFile);
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    if (!m_cacheOnly)
+    {
+        // Expired entries are still served when replaying a session offline
+        QDateTime storedAt = cacheFileInfo.lastModified().toUTC();
+        if (timeToLive(source) < storedAt.secsTo(now))
+        {
+            remove(key);
+            return false;
+        }
+    }
+
+    if (!cacheFile.open(QIODevice::ReadOnly))
+    {
+        remove(key);
+        return false;
+    }
+
+    payload = cacheFile.readAll();
+    cacheFile.setFileTime(now, QFileDevice::FileAccessTime);
+    m_entries[key].lastAccess = now;
+    return true;
+}
+
+void ResponseCache::insert(const QString &source, const QUrl &url, const QByteArray &payload)
+{
+    if (timeToLive(source) <= 0 || m_maximumSize < payload.size())
+    {
+        return;
+    }
+
+    QString key = cacheKey(source, url);
+    QFile cacheFile(filePath(key));
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "Cache file" << cacheFile.fileName() << "cannot be written!";
+        return;
+    }
+    cacheFile.write(payload);
+    cacheFile.close();
+
+    if (m_entries.contains(key))
+    {
+        m_currentSize -= m_entries[key].size;
+    }
+
+    CacheEntry entry;
+    entry.size = payload.size();
+    entry.lastAccess = QDateTime::currentDateTimeUtc();
+    m_entries.insert(key, entry);
+    m_currentSize += entry.size;
+    evict();
+}
+
+QString ResponseCache::normalizedUrl(const QUrl &url)
+{
+    // Scheme and host are case insensitive and the order of the query items does not matter
+    QUrl normalized = url.adjusted(QUrl::NormalizePathSegments | QUrl::StripTrailingSlash | QUrl::RemoveFragment);
+    normalized.setScheme(normalized.scheme().toLower());
+    normalized.setHost(normalized.host().toLower());
+
+    QList<QPair<QString, QString>> queryItems = QUrlQuery(url).queryItems(QUrl::FullyDecoded);
+    std::sort(queryItems.begin(), queryItems.end());
+    QUrlQuery sortedQuery;
+    for (const QPair<QString, QString>& queryItem : queryItems)
+    {
+        sortedQuery.addQueryItem(queryItem.first, queryItem.second.trimmed());
+    }
+    normalized.setQuery(sortedQuery);
+    return normalized.toString(QUrl::FullyEncoded);
+}
+
+QString ResponseCache::cacheKey(const QString &source, const QUrl &url) const
+{
+    // Content addressed by the normalized request
+    QByteArray keyData = (source + "|" + normalizedUrl(url)).toUtf8();
+    return QCryptographicHash::hash(keyData, QCryptographicHash::Sha1).toHex();
+}
+
+QString ResponseCache::filePath(const QString &key) const
+{
+    return QDir(m_cacheDirectory).filePath(key + ".cache");
+}
+
+void ResponseCache::loadIndex()
+{
+    m_entries.clear();
+    m_currentSize = 0;
+
+    QDir cacheDir(m_cacheDirectory);
+    QFileInfoList cacheFileInfos = cacheDir.entryInfoList(QStringList() << "*.cache", QDir::Files);
+    foreach (const QFileInfo& cacheFileInfo, cacheFileInfos)
+    {
+        CacheEntry entry;
+        entry.size = cacheFileInfo.size();
+        entry.lastAccess = cacheFileInfo.lastRead().toUTC();
+        m_entries.insert(cacheFileInfo.completeBaseName(), entry);
+        m_currentSize += entry.size;
+    }
+
+    evict();
+}
+
+void ResponseCache::evict()
+{
+    if (m_currentSize <= m_maximumSize)
+    {
+        return;
+    }
+
+    // Least recently used entries are removed first
+    QList<QPair<QDateTime, QString>> entriesByAccess;
+    for (auto entryIterator = m_entries.constBegin(); entryIterator != m_entries.constEnd(); ++entryIterator)
+    {
+        entriesByAccess.append(qMakePair(entryIterator.value().lastAccess, entryIterator.key()));
+    }
+    std::sort(entriesByAccess.begin(), entriesByAccess.end());
+
+    for (const QPair<QDateTime, QString>& entryByAccess : entriesByAccess)
+    {
+        if (m_currentSize <= m_maximumSize)
+        {
+            break;
+        }
+        remove(entryByAccess.second);
+    }
+}
+
+void ResponseCache::remove(const QString &key)
+{
+    if (!m_entries.contains(key))
+    {
+        return;
+    }
+
+    m_currentSize -= m_entries.take(key).size;
+    QFile::remove(filePath(key));
+}
@@ -0,0 +1,81 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QUrl>
+
+class ResponseCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ResponseCache(QObject *parent = nullptr);
+
+    void setCacheDirectory(const QString& cacheDirectory);
+    QString cacheDirectory() const;
+
+    void setTimeToLive(const QString& source, qint64 seconds);
+    qint64 timeToLive(const QString& source) const;
+
+    void setMaximumSize(qint64 maximumSize);
+    qint64 maximumSize() const;
+
+    void setCacheOnly(bool cacheOnly);
+    bool isCacheOnly() const;
+
+    bool lookup(const QString& source, const QUrl& url, QByteArray& payload);
+
+    void insert(const QString& source, const QUrl& url, const QByteArray& payload);
+
+    static QString normalizedUrl(const QUrl& url);
+
+signals:
+
+private:
+    struct CacheEntry
+    {
+        qint64 size = 0;
+        QDateTime lastAccess;
+    };
+
+    QString cacheKey(const QString& source, const QUrl& url) const;
+    QString filePath(const QString& key) const;
+
+    void loadIndex();
+    void evict();
+    void remove(const QString& key);
+
+    QString m_cacheDirectory;
+    QHash<QString, qint64> m_timeToLiveBySource;
+    qint64 m_maximumSize = 256 * 1024 * 1024;
+    qint64 m_currentSize = 0;
+    bool m_cacheOnly = false;
+
+    QHash<QString, CacheEntry> m_entries;
+};
+
+#endif // RESPONSECACHE_H
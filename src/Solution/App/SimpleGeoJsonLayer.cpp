@@ -23,28 +23,57 @@
 //
 #include "SimpleGeoJsonLayer.h"
 
+#include "FeatureParsePipeline.h"
 #include "GraphicsFactory.h"
+#include "ResponseCache.h"
+#include "StreamDecompressor.h"
 
+#include "Envelope.h"
+#include "Graphic.h"
 #include "GraphicsOverlay.h"
 #include "SimpleFillSymbol.h"
 #include "SimpleMarkerSymbol.h"
 #include "SimpleRenderer.h"
 
-#include <QJsonArray>
-#include <QJsonDocument>
+#include <QFile>
+#include <QFileInfo>
 #include <QNetworkReply>
+#include <QSet>
+#include <QTextCodec>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrent>
 
 using namespace Esri::ArcGISRuntime;
 
+namespace
+{
+// Bounded number of feature batches in memory, enough to keep every core busy
+const int MaxPendingBatchCount = qMax(4, QThread::idealThreadCount());
+const int BatchFeatureCount = 1000;
+const qint64 ChunkSize = 1024 * 1024;
+
+// Compressed sources inflate roughly ten times, so their chunks are smaller
+const qint64 CompressedChunkSize = 128 * 1024;
+}
+
 SimpleGeoJsonLayer::SimpleGeoJsonLayer(QObject *parent) :
     QObject(parent),
     m_networkAccessManager(new QNetworkAccessManager(this)),
     m_pointsOverlay(new GraphicsOverlay(this)),
     m_linesOverlay(new GraphicsOverlay(this)),
     m_areasOverlay(new GraphicsOverlay(this)),
-    m_graphicsFactor(new GraphicsFactory(this))
+    m_graphicsFactor(new GraphicsFactory(this)),
+    m_parsePipeline(new FeatureParsePipeline(this)),
+    m_refreshTimer(new QTimer(this))
 {
     connect(m_networkAccessManager, &QNetworkAccessManager::finished, this, &SimpleGeoJsonLayer::networkRequestFinished);
+    connect(m_parsePipeline, &FeatureParsePipeline::featuresParsed, this, &SimpleGeoJsonLayer::featuresParsed);
+
+    // Loading batches refresh the visible tiles a few times per second
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(250);
+    connect(m_refreshTimer, &QTimer::timeout, this, &SimpleGeoJsonLayer::refreshTiles);
 
     SimpleRenderer* fillRenderer = new SimpleRenderer(this);
     SimpleFillSymbol* fillSymbol = new SimpleFillSymbol(SimpleFillSymbolStyle::Solid, QColor("#d3c2a6"), this);
@@ -83,8 +112,34 @@ GraphicsOverlay* SimpleGeoJsonLayer::areasOverlay() const
 
 void SimpleGeoJsonLayer::query(const QUrl &geoJsonUrl)
 {
+    // The download pauses when the buffer is full and the parsers are busy
+    const qint64 readBufferSize = 4 * 1024 * 1024;
     QNetworkRequest geoJsonRequest(geoJsonUrl);
-    m_networkAccessManager->get(geoJsonRequest);
+
+    // Compressed payloads are inflated while they are parsed
+    geoJsonRequest.setRawHeader("Accept-Encoding", StreamDecompressor::acceptEncoding());
+
+    // Cached sources are only downloaded again when they changed
+    QString source = ResponseCache::normalizedUrl(geoJsonUrl);
+    QString validator = m_binaryCache.validator(source);
+    if (validator.startsWith("etag:"))
+    {
+        geoJsonRequest.setRawHeader("If-None-Match", validator.mid(5).toLatin1());
+    }
+    else if (validator.startsWith("modified:"))
+    {
+        geoJsonRequest.setRawHeader("If-Modified-Since", validator.mid(9).toLatin1());
+    }
+
+    QNetworkReply* reply = m_networkAccessManager->get(geoJsonRequest);
+    reply->setReadBufferSize(readBufferSize);
+    QSharedPointer<GeoJsonStream> stream(new GeoJsonStream);
+    stream->source = source;
+    m_streams.insert(reply, stream);
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]()
+    {
+        readStream(reply);
+    });
 }
 
 void SimpleGeoJsonLayer::networkRequestFinished(QNetworkReply *reply)
@@ -92,12 +147,623 @@ void SimpleGeoJsonLayer::networkRequestFinished(QNetworkReply *reply)
     if (reply->error())
     {
         qDebug() << reply->errorString();
+        QSharedPointer<GeoJsonStream> stream = m_streams.take(reply);
+        if (stream)
+        {
+            endSource(stream->sourceId, false);
+        }
+        reply->deleteLater();
+        return;
+    }
+
+    // Unchanged sources are read from their binary copy
+    if (304 == reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt())
+    {
+        QSharedPointer<GeoJsonStream> stream = m_streams.take(reply);
+        reply->deleteLater();
+        if (stream && !loadCachedSource(stream->source, m_binaryCache.validator(stream->source)))
+        {
+            qDebug() << "GeoJSON cache file cannot be read, downloading the source again.";
+            m_binaryCache.remove(stream->source);
+            query(reply->request().url());
+        }
+        return;
+    }
+
+    // Reads the remaining bytes unless the parsers are busy
+    readStream(reply);
+}
+
+void SimpleGeoJsonLayer::updateTiles(const Envelope &visibleExtent, double degreesPerPixel)
+{
+    m_visibleExtent = QRectF(QPointF(visibleExtent.xMin(), visibleExtent.yMin()), QPointF(visibleExtent.xMax(), visibleExtent.yMax()));
+    m_zoom = GeoJsonTileIndex::zoomForResolution(degreesPerPixel);
+    refreshTiles();
+}
+
+void SimpleGeoJsonLayer::clear(GraphicsOverlay *overlay)
+{
+    GeometryType geometryType = GeometryType::Polygon;
+    if (m_pointsOverlay == overlay)
+    {
+        geometryType = GeometryType::Point;
+    }
+    else if (m_linesOverlay == overlay)
+    {
+        geometryType = GeometryType::Polyline;
+    }
+
+    m_tileIndex.remove(geometryType);
+    refreshTiles();
+}
+
+bool SimpleGeoJsonLayer::removeSelectedGraphics(GraphicsOverlay *overlay)
+{
+    // The selected tile graphics remove their source features
+    QList<int> featureIds;
+    QList<Graphic*> selectedGraphics = overlay->selectedGraphics();
+    foreach (Graphic* selectedGraphic, selectedGraphics)
+    {
+        auto featureIdIterator = m_featureIdsByGraphic.constFind(selectedGraphic);
+        if (featureIdIterator != m_featureIdsByGraphic.constEnd())
+        {
+            featureIds.append(featureIdIterator.value());
+        }
+    }
+
+    if (featureIds.isEmpty())
+    {
+        return false;
+    }
+
+    m_tileIndex.remove(featureIds);
+    refreshTiles();
+    return true;
+}
+
+void SimpleGeoJsonLayer::readStream(QNetworkReply *reply)
+{
+    QSharedPointer<GeoJsonStream> stream = m_streams.value(reply);
+    if (!stream)
+    {
         return;
     }
 
-    // Encoding tests
-    QByteArray jsonResponse = reply->readAll();
-    bool unknownEncoding = true;
+    // Not modified replies have no content
+    if (304 == reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt())
+    {
+        return;
+    }
+
+    if (!stream->started)
+    {
+        // Content encoding tests, compressed files without a content encoding are recognized by their magic number
+        QByteArray contentEncoding = reply->rawHeader("Content-Encoding");
+        StreamDecompressor::Encoding encoding = StreamDecompressor::encodingOf(contentEncoding);
+        if (contentEncoding.trimmed().isEmpty())
+        {
+            const qint64 magicSize = 4;
+            if (reply->bytesAvailable() < magicSize && !reply->isFinished())
+            {
+                return;
+            }
+            encoding = StreamDecompressor::detectEncoding(reply->peek(magicSize));
+        }
+        if (!StreamDecompressor::isSupported(encoding))
+        {
+            qDebug() << "GeoJSON has unsupported content encoding!" << contentEncoding;
+            m_streams.remove(reply);
+            reply->abort();
+            return;
+        }
+        if (StreamDecompressor::Encoding::Identity != encoding)
+        {
+            stream->decompressor.reset(new StreamDecompressor(encoding));
+        }
+
+        // Encoding tests, compressed GeoJSON files are UTF-8 encoded
+        QString charset = contentCharset(reply);
+        if (charset.isEmpty() && stream->decompressor && contentEncoding.trimmed().isEmpty())
+        {
+            charset = "utf-8";
+        }
+        QTextCodec* codec = charset.isEmpty() ? nullptr : QTextCodec::codecForName(charset.toLatin1());
+        if (nullptr == codec)
+        {
+            qDebug() << "GeoJSON has unknown encoding!";
+            m_streams.remove(reply);
+            reply->abort();
+            return;
+        }
+
+        if (!charset.startsWith("utf-8", Qt::CaseInsensitive))
+        {
+            qDebug() << "Converting GeoJSON from" << charset << "to UTF-8";
+            stream->decoder.reset(codec->makeDecoder());
+        }
+        stream->sourceId = beginSource(stream->source, replyValidator(reply));
+        stream->started = true;
+    }
+
+    qint64 chunkSize = stream->decompressor ? CompressedChunkSize : ChunkSize;
+    while (m_pendingBatchCount < MaxPendingBatchCount && 0 < reply->bytesAvailable())
+    {
+        QByteArray chunk = reply->read(chunkSize);
+        if (!addStreamData(*stream, chunk.constData(), chunk.size()))
+        {
+            qDebug() << "GeoJSON cannot be decompressed!" << stream->decompressor->errorString();
+            endSource(stream->sourceId, false);
+            m_streams.remove(reply);
+            reply->abort();
+            return;
+        }
+
+        if (BatchFeatureCount <= stream->reader.pendingFeatureCount())
+        {
+            submitFeatures(stream->reader.takeFeatures(), stream->sourceId);
+        }
+    }
+
+    // Feeds of feature sequences may never end, so they are not cached
+    if (stream->reader.isSequence() && 0 != stream->sourceId)
+    {
+        endSource(stream->sourceId, false);
+        stream->sourceId = 0;
+    }
+
+    // Idle parsers get the features read so far, so that the first ones and slow feeds show up right away
+    if (0 < stream->reader.pendingFeatureCount() && 0 == m_pendingBatchCount)
+    {
+        submitFeatures(stream->reader.takeFeatures(), stream->sourceId);
+    }
+
+    if (reply->isFinished() && 0 == reply->bytesAvailable())
+    {
+        if (0 < stream->reader.pendingFeatureCount())
+        {
+            submitFeatures(stream->reader.takeFeatures(), stream->sourceId);
+        }
+        if (!stream->reader.atEnd())
+        {
+            qDebug() << "GeoJSON is incomplete!";
+        }
+        endSource(stream->sourceId, stream->reader.atEnd());
+        m_streams.remove(reply);
+        reply->deleteLater();
+    }
+}
+
+void SimpleGeoJsonLayer::loadFile(const QString &filePath)
+{
+    // Unchanged files are read from their binary copy
+    QString source = QFileInfo(filePath).absoluteFilePath();
+    QString validator = GeoJsonBinaryCache::fileValidator(filePath);
+    if (!validator.isEmpty() && validator == m_binaryCache.validator(source) && loadCachedSource(source, validator))
+    {
+        return;
+    }
+
+    QFile* geoJsonFile = new QFile(filePath, this);
+    if (!geoJsonFile->open(QIODevice::ReadOnly))
+    {
+        qDebug() << geoJsonFile->errorString();
+        delete geoJsonFile;
+        return;
+    }
+
+    // GeoJSON files are UTF-8 encoded and parsed straight from the mapping
+    QSharedPointer<GeoJsonStream> stream(new GeoJsonStream);
+    stream->started = true;
+    stream->mapping = geoJsonFile->map(0, geoJsonFile->size());
+    if (nullptr == stream->mapping && 0 < geoJsonFile->size())
+    {
+        qDebug() << "GeoJSON file cannot be mapped!" << geoJsonFile->errorString();
+        delete geoJsonFile;
+        return;
+    }
+
+    // Compressed files like .geojson.gz are inflated chunk by chunk from the mapping
+    const qint64 magicSize = 4;
+    QByteArray magic = QByteArray::fromRawData(reinterpret_cast<const char*>(stream->mapping), int(qMin(magicSize, geoJsonFile->size())));
+    StreamDecompressor::Encoding encoding = StreamDecompressor::detectEncoding(magic);
+    if (!StreamDecompressor::isSupported(encoding))
+    {
+        qDebug() << "GeoJSON file has unsupported compression!" << geoJsonFile->fileName();
+        delete geoJsonFile;
+        return;
+    }
+    if (StreamDecompressor::Encoding::Identity != encoding)
+    {
+        stream->decompressor.reset(new StreamDecompressor(encoding));
+    }
+
+    stream->source = source;
+    stream->sourceId = beginSource(source, validator);
+    m_fileStreams.insert(geoJsonFile, stream);
+    readFile(geoJsonFile);
+}
+
+void SimpleGeoJsonLayer::readFile(QFile *file)
+{
+    QSharedPointer<GeoJsonStream> stream = m_fileStreams.value(file);
+    if (!stream)
+    {
+        return;
+    }
+
+    qint64 fileSize = file->size();
+    const char* mappedBytes = reinterpret_cast<const char*>(stream->mapping);
+    qint64 maxChunkSize = stream->decompressor ? CompressedChunkSize : ChunkSize;
+    while (m_pendingBatchCount < MaxPendingBatchCount && stream->position < fileSize)
+    {
+        int chunkSize = int(qMin(maxChunkSize, fileSize - stream->position));
+        if (!addStreamData(*stream, mappedBytes + stream->position, chunkSize))
+        {
+            qDebug() << "GeoJSON file cannot be decompressed!" << stream->decompressor->errorString();
+            endSource(stream->sourceId, false);
+            m_fileStreams.remove(file);
+            delete file;
+            return;
+        }
+        stream->position += chunkSize;
+        if (BatchFeatureCount <= stream->reader.pendingFeatureCount()
+                || (0 < stream->reader.pendingFeatureCount() && 0 == m_pendingBatchCount))
+        {
+            submitFeatures(stream->reader.takeFeatures(), stream->sourceId);
+        }
+        emit loadProgress(stream->position, fileSize);
+    }
+
+    if (fileSize <= stream->position)
+    {
+        if (0 < stream->reader.pendingFeatureCount())
+        {
+            submitFeatures(stream->reader.takeFeatures(), stream->sourceId);
+        }
+        if (!stream->reader.atEnd())
+        {
+            qDebug() << "GeoJSON is incomplete!";
+        }
+        endSource(stream->sourceId, stream->reader.atEnd());
+        m_fileStreams.remove(file);
+        delete file;
+    }
+}
+
+bool SimpleGeoJsonLayer::addStreamData(GeoJsonStream &stream, const char *data, int size)
+{
+    // Inflated blocks go straight into the reader, the inflated document is never held in memory
+    auto addData = [&stream](const char* inflatedData, int inflatedSize)
+    {
+        if (stream.decoder)
+        {
+            stream.reader.addData(stream.decoder->toUnicode(inflatedData, inflatedSize).toUtf8());
+        }
+        else
+        {
+            stream.reader.addData(inflatedData, inflatedSize);
+        }
+    };
+
+    if (stream.decompressor)
+    {
+        return stream.decompressor->decompress(data, size, addData);
+    }
+
+    addData(data, size);
+    return true;
+}
+
+void SimpleGeoJsonLayer::submitFeatures(const QByteArray &featuresJson, int sourceId)
+{
+    // GeoJSON layers accumulate their sources, so no load supersedes another one
+    m_pendingBatchCount++;
+    auto sourceLoadIterator = m_sourceLoads.find(sourceId);
+    if (sourceLoadIterator != m_sourceLoads.end())
+    {
+        sourceLoadIterator->pendingBatchCount++;
+    }
+    m_parsePipeline->submit(m_parsePipeline->generation(), [featuresJson](const CancelCheck& isCanceled)
+    {
+        return GraphicsFactory::parseFeatureArray(featuresJson, isCanceled);
+    }, sourceId);
+}
+
+int SimpleGeoJsonLayer::beginSource(const QString &source, const QString &validator)
+{
+    // Sources without a validator cannot be checked for changes, so they are never cached
+    if (validator.isEmpty())
+    {
+        return 0;
+    }
+
+    int sourceId = m_nextSourceId++;
+    SourceLoad& sourceLoad = m_sourceLoads[sourceId];
+    sourceLoad.source = source;
+    sourceLoad.validator = validator;
+    return sourceId;
+}
+
+void SimpleGeoJsonLayer::endSource(int sourceId, bool complete)
+{
+    auto sourceLoadIterator = m_sourceLoads.find(sourceId);
+    if (sourceLoadIterator == m_sourceLoads.end())
+    {
+        return;
+    }
+
+    if (!complete)
+    {
+        m_sourceLoads.erase(sourceLoadIterator);
+        return;
+    }
+
+    sourceLoadIterator->complete = true;
+    if (0 == sourceLoadIterator->pendingBatchCount)
+    {
+        writeSource(sourceId);
+    }
+}
+
+void SimpleGeoJsonLayer::writeSource(int sourceId)
+{
+    // The binary copy is written on the worker pool
+    SourceLoad sourceLoad = m_sourceLoads.take(sourceId);
+    ParsedFeatureList features;
+    if (!m_tileIndex.features(sourceLoad.featureIds, features))
+    {
+        // Features removed while the source was loaded would come back with the copy
+        return;
+    }
+
+    GeoJsonBinaryCache binaryCache = m_binaryCache;
+    QtConcurrent::run(QThreadPool::globalInstance(), [binaryCache, sourceLoad, features]()
+    {
+        binaryCache.write(sourceLoad.source, sourceLoad.validator, features);
+    });
+}
+
+bool SimpleGeoJsonLayer::loadCachedSource(const QString &source, const QString &validator)
+{
+    QSharedPointer<CachedLoad> cachedLoad(new CachedLoad);
+    cachedLoad->sourceName = source;
+    cachedLoad->source = m_binaryCache.open(source, validator);
+    if (!cachedLoad->source.isValid())
+    {
+        return false;
+    }
+
+    // Features are spatially ordered, so the batches covering the visible extent are read first
+    int featureCount = cachedLoad->source.featureCount();
+    QList<int> hiddenBatchOffsets;
+    for (int batchOffset = 0; batchOffset < featureCount; batchOffset += BatchFeatureCount)
+    {
+        QRectF batchExtent = cachedLoad->source.extent(batchOffset, qMin(batchOffset + BatchFeatureCount, featureCount));
+        if (m_visibleExtent.intersects(batchExtent))
+        {
+            cachedLoad->batchOffsets.append(batchOffset);
+        }
+        else
+        {
+            hiddenBatchOffsets.append(batchOffset);
+        }
+    }
+    cachedLoad->batchOffsets.append(hiddenBatchOffsets);
+
+    m_cachedLoads.append(cachedLoad);
+    readCachedSource(cachedLoad);
+    return true;
+}
+
+void SimpleGeoJsonLayer::readCachedSource(const QSharedPointer<CachedLoad> &cachedLoad)
+{
+    // Cached sources report their progress in features
+    int featureCount = cachedLoad->source.featureCount();
+    while (m_pendingBatchCount < MaxPendingBatchCount && !cachedLoad->batchOffsets.isEmpty())
+    {
+        int batchOffset = cachedLoad->batchOffsets.takeFirst();
+        int batchEnd = qMin(batchOffset + BatchFeatureCount, featureCount);
+        GeoJsonBinaryCache::Source cachedSource = cachedLoad->source;
+        QString source = cachedLoad->sourceName;
+        m_pendingBatchCount++;
+        m_parsePipeline->submit(m_parsePipeline->generation(), [this, cachedSource, source, batchOffset, batchEnd](const CancelCheck& isCanceled)
+        {
+            Q_UNUSED(isCanceled);
+            bool valid = true;
+            ParsedFeatureList features = cachedSource.readFeatures(batchOffset, batchEnd, &valid);
+            if (!valid)
+            {
+                // The layer is only used as the receiver of the queued call
+                QMetaObject::invokeMethod(this, [this, source]()
+                {
+                    discardCachedSource(source);
+                }, Qt::QueuedConnection);
+            }
+            return features;
+        });
+        cachedLoad->readCount += batchEnd - batchOffset;
+        emit loadProgress(cachedLoad->readCount, featureCount);
+    }
+
+    if (cachedLoad->batchOffsets.isEmpty())
+    {
+        m_cachedLoads.removeOne(cachedLoad);
+    }
+}
+
+void SimpleGeoJsonLayer::discardCachedSource(const QString &source)
+{
+    // The remaining batches of a corrupted copy are not read, the next load downloads the source again
+    for (int loadIndex = m_cachedLoads.count() - 1; 0 <= loadIndex; loadIndex--)
+    {
+        if (source == m_cachedLoads.at(loadIndex)->sourceName)
+        {
+            m_cachedLoads.removeAt(loadIndex);
+        }
+    }
+    m_binaryCache.remove(source);
+}
+
+void SimpleGeoJsonLayer::featuresParsed(quint64 generation, const ParsedFeatureList &features, int sourceId)
+{
+    Q_UNUSED(generation);
+    m_pendingBatchCount--;
+    QVector<int> featureIds;
+    if (features.isEmpty())
+    {
+        qDebug() << "No GeoJSON feature was added!";
+    }
+    else
+    {
+        featureIds = m_tileIndex.insert(features);
+        if (!m_refreshTimer->isActive())
+        {
+            m_refreshTimer->start();
+        }
+    }
+
+    auto sourceLoadIterator = m_sourceLoads.find(sourceId);
+    if (sourceLoadIterator != m_sourceLoads.end())
+    {
+        sourceLoadIterator->featureIds += featureIds;
+        sourceLoadIterator->pendingBatchCount--;
+        if (sourceLoadIterator->complete && 0 == sourceLoadIterator->pendingBatchCount)
+        {
+            writeSource(sourceId);
+        }
+    }
+
+    // Continue reading the paused replies
+    QList<QNetworkReply*> replies = m_streams.keys();
+    foreach (QNetworkReply* reply, replies)
+    {
+        readStream(reply);
+    }
+    QList<QFile*> files = m_fileStreams.keys();
+    foreach (QFile* file, files)
+    {
+        readFile(file);
+    }
+    QList<QSharedPointer<CachedLoad>> cachedLoads = m_cachedLoads;
+    foreach (const QSharedPointer<CachedLoad>& cachedLoad, cachedLoads)
+    {
+        readCachedSource(cachedLoad);
+    }
+}
+
+void SimpleGeoJsonLayer::refreshTiles()
+{
+    m_refreshTimer->stop();
+
+    QList<quint64> visibleTileKeys = GeoJsonTileIndex::coveringTiles(m_visibleExtent, m_zoom);
+    QSet<quint64> visibleTiles = QSet<quint64>::fromList(visibleTileKeys);
+
+    // Tiles leaving the visible extent and tiles of changed features are dropped, the others are kept
+    QList<Graphic*> droppedGraphics;
+    QList<quint64> shownTileKeys = m_tileGraphics.keys();
+    foreach (quint64 tileKey, shownTileKeys)
+    {
+        if (!visibleTiles.contains(tileKey) || m_tileIndex.isTileChanged(tileKey))
+        {
+            droppedGraphics.append(m_tileGraphics.take(tileKey));
+        }
+    }
+    m_tileIndex.acceptChanges();
+
+    if (!droppedGraphics.isEmpty())
+    {
+        // Rebuilding the overlays is cheaper than removing the graphics one by one
+        m_pointsOverlay->graphics()->clear();
+        m_linesOverlay->graphics()->clear();
+        m_areasOverlay->graphics()->clear();
+
+        QList<Graphic*> pointGraphics;
+        QList<Graphic*> lineGraphics;
+        QList<Graphic*> areaGraphics;
+        foreach (const QList<Graphic*>& tileGraphics, m_tileGraphics)
+        {
+            foreach (Graphic* tileGraphic, tileGraphics)
+            {
+                switch (tileGraphic->geometry().geometryType())
+                {
+                case GeometryType::Point:
+                    pointGraphics.append(tileGraphic);
+                    break;
+
+                case GeometryType::Polyline:
+                    lineGraphics.append(tileGraphic);
+                    break;
+
+                default:
+                    areaGraphics.append(tileGraphic);
+                    break;
+                }
+            }
+        }
+        if (!pointGraphics.isEmpty())
+        {
+            m_pointsOverlay->graphics()->append(pointGraphics);
+        }
+        if (!lineGraphics.isEmpty())
+        {
+            m_linesOverlay->graphics()->append(lineGraphics);
+        }
+        if (!areaGraphics.isEmpty())
+        {
+            m_areasOverlay->graphics()->append(areaGraphics);
+        }
+
+        foreach (Graphic* droppedGraphic, droppedGraphics)
+        {
+            m_featureIdsByGraphic.remove(droppedGraphic);
+        }
+        qDeleteAll(droppedGraphics);
+    }
+
+    // Only the tiles entering the visible extent are materialized
+    ParsedFeatureList newFeatures;
+    QVector<int> newFeatureIds;
+    QList<QPair<quint64, int>> newTiles;
+    foreach (quint64 tileKey, visibleTileKeys)
+    {
+        if (m_tileGraphics.contains(tileKey))
+        {
+            continue;
+        }
+
+        GeoJsonTileIndex::Tile tile = m_tileIndex.tile(tileKey);
+        newFeatures.append(tile.features);
+        newFeatureIds += tile.featureIds;
+        newTiles.append(qMakePair(tileKey, tile.features.count()));
+        m_tileGraphics.insert(tileKey, QList<Graphic*>());
+    }
+
+    if (newFeatures.isEmpty())
+    {
+        return;
+    }
+
+    QList<Graphic*> newGraphics = m_graphicsFactor->createGraphics(newFeatures, m_pointsOverlay, m_linesOverlay, m_areasOverlay);
+    int featureIndex = 0;
+    foreach (const auto& newTile, newTiles)
+    {
+        QList<Graphic*>& tileGraphics = m_tileGraphics[newTile.first];
+        for (int tileFeatureIndex = 0; tileFeatureIndex < newTile.second; tileFeatureIndex++, featureIndex++)
+        {
+            Graphic* newGraphic = newGraphics.at(featureIndex);
+            if (nullptr != newGraphic)
+            {
+                tileGraphics.append(newGraphic);
+                m_featureIdsByGraphic.insert(newGraphic, newFeatureIds.at(featureIndex));
+            }
+        }
+    }
+
+}
+
+QString SimpleGeoJsonLayer::contentCharset(QNetworkReply *reply)
+{
+    QString charset;
     if (reply->rawHeaderList().contains("Content-Type"))
     {
         QString contentType = reply->rawHeader("Content-Type");
@@ -110,60 +776,48 @@ void SimpleGeoJsonLayer::networkRequestFinished(QNetworkReply *reply)
                 QStringList charsetEntries = contentTypeEntryTrimmed.split("=");
                 if (2 == charsetEntries.count())
                 {
-                    QString charset = charsetEntries.at(1).trimmed();
+                    charset = charsetEntries.at(1).trimmed();
                     qDebug() << "GeoJSON has " << charset << " encoding.";
-                    if (charset.startsWith("ISO-8859-", Qt::CaseInsensitive))
-                    {
-                        // Treat as Latin 1-16 and convert to UTF-8
-                        QString jsonAsLatin1 = QString::fromLatin1(jsonResponse);
-                        qDebug() << "Converting GeoJSON from Latin 1 to UTF-8";
-                        jsonResponse = jsonAsLatin1.toUtf8();
-                        unknownEncoding = false;
-                    }
-                    else if (charset.startsWith("utf-16", Qt::CaseInsensitive))
-                    {
-                        QString jsonAsUtf16 = jsonResponse;
-                        qDebug() << "Converting GeoJSON from UTF-16 to UTF-8";
-                        jsonResponse = jsonAsUtf16.toUtf8();
-                        unknownEncoding = false;
-                    }
-                    else if (charset.startsWith("utf-32", Qt::CaseInsensitive))
+                    if (charset.startsWith("utf-32", Qt::CaseInsensitive))
                     {
                         qDebug() << "UTF-32 is not supported!";
-                        //QString::fromUcs4(jsonResponse.data());
-                        //unknownEncoding = false;
+                        charset.clear();
                     }
-                    else if (charset.startsWith("utf-8", Qt::CaseInsensitive))
+                    else if (!charset.startsWith("ISO-8859-", Qt::CaseInsensitive)
+                             && !charset.startsWith("utf-16", Qt::CaseInsensitive)
+                             && !charset.startsWith("utf-8", Qt::CaseInsensitive))
                     {
-                        unknownEncoding = false;
+                        charset.clear();
                     }
                 }
             }
         }
-    }
 
-    if (unknownEncoding)
-    {
-        qDebug() << "GeoJSON has unknown encoding!";
-        return;
+        // Text sequences and newline delimited JSON are always UTF-8 encoded
+        QString mediaType = contentTypeEntries.first().trimmed();
+        if (charset.isEmpty()
+                && (mediaType.endsWith("json-seq", Qt::CaseInsensitive) || mediaType.endsWith("ndjson", Qt::CaseInsensitive)))
+        {
+            charset = "utf-8";
+        }
     }
 
-    QJsonDocument geoJsonDocument = QJsonDocument::fromJson(jsonResponse);
-    if (geoJsonDocument.isNull())
-    {
-        qDebug() << "JSON is invalid!";
-        return;
-    }
-    if (!geoJsonDocument.isObject())
+    return charset;
+}
+
+QString SimpleGeoJsonLayer::replyValidator(QNetworkReply *reply)
+{
+    // Entity tags are preferred over the modification time
+    QByteArray entityTag = reply->rawHeader("ETag");
+    if (!entityTag.isEmpty())
     {
-        qDebug() << "JSON document is not an object!";
-        return;
+        return "etag:" + QString::fromLatin1(entityTag);
     }
 
-    QJsonObject geoJsonObject = geoJsonDocument.object();
-    QJsonArray geoJsonFeaturesArray = geoJsonObject["features"].toArray();
-    if (!m_graphicsFactor->createGraphics(geoJsonFeaturesArray, m_pointsOverlay, m_linesOverlay, m_areasOverlay))
+    QByteArray lastModified = reply->rawHeader("Last-Modified");
+    if (!lastModified.isEmpty())
     {
-        qDebug() << "No GeoJSON feature was added!";
+        return "modified:" + QString::fromLatin1(lastModified);
     }
+    return QString();
 }
@@ -24,12 +24,15 @@
 #ifndef SIMPLEGEOJSONLAYER_H
 #define SIMPLEGEOJSONLAYER_H
 
+class FeatureParsePipeline;
 class GraphicsFactory;
+class StreamDecompressor;
 
 namespace Esri
 {
 namespace ArcGISRuntime
 {
+class Envelope;
 class FeatureCollectionTable;
 class GraphicsOverlay;
 class Graphic;
@@ -37,9 +40,20 @@ class Renderer;
 }
 }
 
+class QFile;
 class QNetworkReply;
+class QTextDecoder;
+class QTimer;
 
+#include "GeoJsonBinaryCache.h"
+#include "GeoJsonStreamReader.h"
+#include "GeoJsonTileIndex.h"
+#include "ParsedFeature.h"
+
+#include <QHash>
 #include <QNetworkAccessManager>
+#include <QRectF>
+#include <QSharedPointer>
 
 #include <QObject>
 
@@ -55,17 +69,105 @@ public:
 
     void query(const QUrl& geoJsonUrl);
 
+    void loadFile(const QString& filePath);
+
+    void updateTiles(const Esri::ArcGISRuntime::Envelope& visibleExtent, double degreesPerPixel);
+
+    void clear(Esri::ArcGISRuntime::GraphicsOverlay* overlay);
+
+    bool removeSelectedGraphics(Esri::ArcGISRuntime::GraphicsOverlay* overlay);
+
 signals:
+    void loadProgress(qint64 bytesRead, qint64 bytesTotal);
 
 private slots:
     void networkRequestFinished(QNetworkReply* reply);
+    void featuresParsed(quint64 generation, const ParsedFeatureList& features, int sourceId);
+    void refreshTiles();
 
 private:
+    struct GeoJsonStream
+    {
+        GeoJsonStreamReader reader;
+        QSharedPointer<QTextDecoder> decoder;
+        QSharedPointer<StreamDecompressor> decompressor;
+        bool started = false;
+
+        // Sources with a validator are cached once all of their features are parsed
+        QString source;
+        int sourceId = 0;
+
+        // Local files are read from the mapping
+        const uchar* mapping = nullptr;
+        qint64 position = 0;
+    };
+
+    struct SourceLoad
+    {
+        QString source;
+        QString validator;
+
+        // The features are read back from the tile index when the copy is written
+        QVector<int> featureIds;
+        int pendingBatchCount = 0;
+        bool complete = false;
+    };
+
+    struct CachedLoad
+    {
+        QString sourceName;
+        GeoJsonBinaryCache::Source source;
+
+        // First feature of the batches not read yet, the visible ones come first
+        QList<int> batchOffsets;
+        int readCount = 0;
+    };
+
+    void readStream(QNetworkReply* reply);
+
+    void readFile(QFile* file);
+
+    bool addStreamData(GeoJsonStream& stream, const char* data, int size);
+
+    void submitFeatures(const QByteArray& featuresJson, int sourceId);
+
+    int beginSource(const QString& source, const QString& validator);
+    void endSource(int sourceId, bool complete);
+    void writeSource(int sourceId);
+
+    bool loadCachedSource(const QString& source, const QString& validator);
+    void readCachedSource(const QSharedPointer<CachedLoad>& cachedLoad);
+    void discardCachedSource(const QString& source);
+
+    static QString contentCharset(QNetworkReply* reply);
+
+    static QString replyValidator(QNetworkReply* reply);
+
     QNetworkAccessManager* m_networkAccessManager = nullptr;
     Esri::ArcGISRuntime::GraphicsOverlay* m_pointsOverlay = nullptr;
     Esri::ArcGISRuntime::GraphicsOverlay* m_linesOverlay = nullptr;
     Esri::ArcGISRuntime::GraphicsOverlay* m_areasOverlay = nullptr;
     GraphicsFactory* m_graphicsFactor = nullptr;
+    FeatureParsePipeline* m_parsePipeline = nullptr;
+
+    // Features are only materialized for the tiles of the visible extent
+    GeoJsonTileIndex m_tileIndex;
+    QRectF m_visibleExtent;
+    int m_zoom = 0;
+    QTimer* m_refreshTimer = nullptr;
+    QHash<quint64, QList<Esri::ArcGISRuntime::Graphic*>> m_tileGraphics;
+    QHash<Esri::ArcGISRuntime::Graphic*, int> m_featureIdsByGraphic;
+
+    // GeoJSON replies being read and the number of feature batches being parsed
+    QHash<QNetworkReply*, QSharedPointer<GeoJsonStream>> m_streams;
+    QHash<QFile*, QSharedPointer<GeoJsonStream>> m_fileStreams;
+    int m_pendingBatchCount = 0;
+
+    // Binary copies of the completely loaded sources
+    GeoJsonBinaryCache m_binaryCache;
+    QHash<int, SourceLoad> m_sourceLoads;
+    QList<QSharedPointer<CachedLoad>> m_cachedLoads;
+    int m_nextSourceId = 1;
 };
 
 #endif // SIMPLEGEOJSONLAYER_H
@@ -0,0 +1,288 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#include "StreamDecompressor.h"
+
+#include <zlib.h>
+#ifdef GEOINT_ZSTD
+#include <zstd.h>
+#endif
+
+#include <cstring>
+
+namespace
+{
+// Inflated bytes handed over at once
+const int OutputBlockSize = 256 * 1024;
+
+bool hasZlibHeader(const char* data, int size)
+{
+    // Compression method 8 and a header check value being a multiple of 31
+    if (size < 2)
+    {
+        return false;
+    }
+    uchar firstByte = uchar(data[0]);
+    uchar secondByte = uchar(data[1]);
+    return 8 == (firstByte & 0x0f) && 0 == ((firstByte << 8) | secondByte) % 31;
+}
+}
+
+struct StreamDecompressor::State
+{
+    z_stream zlibStream;
+    bool zlibInitialized = false;
+#ifdef GEOINT_ZSTD
+    ZSTD_DStream* zstdStream = nullptr;
+#endif
+    QByteArray output;
+};
+
+StreamDecompressor::StreamDecompressor(Encoding encoding) :
+    m_encoding(encoding),
+    m_state(new State)
+{
+    std::memset(&m_state->zlibStream, 0, sizeof(z_stream));
+    m_state->output.resize(OutputBlockSize);
+#ifdef GEOINT_ZSTD
+    if (Encoding::Zstd == encoding)
+    {
+        m_state->zstdStream = ZSTD_createDStream();
+        ZSTD_initDStream(m_state->zstdStream);
+    }
+#endif
+}
+
+StreamDecompressor::~StreamDecompressor()
+{
+    if (m_state->zlibInitialized)
+    {
+        inflateEnd(&m_state->zlibStream);
+    }
+#ifdef GEOINT_ZSTD
+    if (nullptr != m_state->zstdStream)
+    {
+        ZSTD_freeDStream(m_state->zstdStream);
+    }
+#endif
+}
+
+StreamDecompressor::Encoding StreamDecompressor::encoding() const
+{
+    return m_encoding;
+}
+
+bool StreamDecompressor::decompress(const char *data, int size, const Consumer &consume)
+{
+    if (!m_errorString.isEmpty())
+    {
+        return false;
+    }
+
+    switch (m_encoding)
+    {
+    case Encoding::Identity:
+        consume(data, size);
+        return true;
+
+    case Encoding::Gzip:
+    case Encoding::Deflate:
+        return inflateData(data, size, consume);
+
+    case Encoding::Zstd:
+        return decompressZstd(data, size, consume);
+
+    default:
+        m_errorString = "Unsupported content encoding";
+        return false;
+    }
+}
+
+bool StreamDecompressor::atEnd() const
+{
+    return m_atEnd;
+}
+
+QString StreamDecompressor::errorString() const
+{
+    return m_errorString;
+}
+
+StreamDecompressor::Encoding StreamDecompressor::encodingOf(const QByteArray &contentEncoding)
+{
+    QByteArray encodingName = contentEncoding.trimmed().toLower();
+    if (encodingName.isEmpty() || "identity" == encodingName)
+    {
+        return Encoding::Identity;
+    }
+    if ("gzip" == encodingName || "x-gzip" == encodingName)
+    {
+        return Encoding::Gzip;
+    }
+    if ("deflate" == encodingName)
+    {
+        return Encoding::Deflate;
+    }
+    if ("zstd" == encodingName)
+    {
+        return Encoding::Zstd;
+    }
+    return Encoding::Unsupported;
+}
+
+StreamDecompressor::Encoding StreamDecompressor::detectEncoding(const QByteArray &leadingBytes)
+{
+    // Compressed files are recognized by their magic numbers
+    if (leadingBytes.startsWith("\x1f\x8b"))
+    {
+        return Encoding::Gzip;
+    }
+    if (leadingBytes.startsWith("\x28\xb5\x2f\xfd"))
+    {
+        return Encoding::Zstd;
+    }
+    if (hasZlibHeader(leadingBytes.constData(), leadingBytes.size()))
+    {
+        return Encoding::Deflate;
+    }
+    return Encoding::Identity;
+}
+
+bool StreamDecompressor::isSupported(Encoding encoding)
+{
+    switch (encoding)
+    {
+    case Encoding::Identity:
+    case Encoding::Gzip:
+    case Encoding::Deflate:
+        return true;
+
+#ifdef GEOINT_ZSTD
+    case Encoding::Zstd:
+        return true;
+#endif
+
+    default:
+        return false;
+    }
+}
+
+QByteArray StreamDecompressor::acceptEncoding()
+{
+    return isSupported(Encoding::Zstd) ? "zstd, gzip, deflate" : "gzip, deflate";
+}
+
+bool StreamDecompressor::inflateData(const char *data, int size, const Consumer &consume)
+{
+    z_stream& zlibStream = m_state->zlibStream;
+    if (!m_state->zlibInitialized)
+    {
+        if (size <= 0)
+        {
+            return true;
+        }
+
+        // Gzip and zlib headers are detected by zlib, deflate without a header is raw
+        int windowBits = 15 + 32;
+        if (Encoding::Deflate == m_encoding && !hasZlibHeader(data, size))
+        {
+            windowBits = -15;
+        }
+        if (Z_OK != inflateInit2(&zlibStream, windowBits))
+        {
+            m_errorString = "Inflating cannot be initialized";
+            return false;
+        }
+        m_state->zlibInitialized = true;
+    }
+
+    zlibStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zlibStream.avail_in = uInt(size);
+    while (!m_atEnd)
+    {
+        zlibStream.next_out = reinterpret_cast<Bytef*>(m_state->output.data());
+        zlibStream.avail_out = uInt(OutputBlockSize);
+        int result = inflate(&zlibStream, Z_NO_FLUSH);
+        if (Z_OK != result && Z_STREAM_END != result && Z_BUF_ERROR != result)
+        {
+            m_errorString = (nullptr != zlibStream.msg) ? QString::fromLatin1(zlibStream.msg) : QString("Inflating failed");
+            return false;
+        }
+
+        int inflatedSize = OutputBlockSize - int(zlibStream.avail_out);
+        if (0 < inflatedSize)
+        {
+            consume(m_state->output.constData(), inflatedSize);
+        }
+
+        if (Z_STREAM_END == result)
+        {
+            // Concatenated gzip members continue the payload
+            if (Encoding::Gzip == m_encoding && 0 < zlibStream.avail_in)
+            {
+                inflateReset(&zlibStream);
+                continue;
+            }
+            m_atEnd = true;
+        }
+        else if (0 == zlibStream.avail_in && 0 < zlibStream.avail_out)
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+bool StreamDecompressor::decompressZstd(const char *data, int size, const Consumer &consume)
+{
+#ifdef GEOINT_ZSTD
+    ZSTD_inBuffer input = { data, size_t(size), 0 };
+    bool outputFull = false;
+    while (input.pos < input.size || outputFull)
+    {
+        ZSTD_outBuffer output = { m_state->output.data(), size_t(OutputBlockSize), 0 };
+        size_t result = ZSTD_decompressStream(m_state->zstdStream, &output, &input);
+        if (ZSTD_isError(result))
+        {
+            m_errorString = QString::fromLatin1(ZSTD_getErrorName(result));
+            return false;
+        }
+
+        if (0 < output.pos)
+        {
+            consume(m_state->output.constData(), int(output.pos));
+        }
+        outputFull = output.pos == output.size;
+
+        // Zero means the current frame is complete, another one may follow
+        m_atEnd = 0 == result;
+    }
+    return true;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+    Q_UNUSED(consume);
+    m_errorString = "Zstandard is not supported by this build";
+    return false;
+#endif
+}
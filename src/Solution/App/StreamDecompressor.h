@@ -0,0 +1,81 @@
+// GEOINT Monitor is a sample native desktop application for geospatial intelligence workflows.
+// Copyright (C) 2020 Jan Tschada (gisfromscratch@live.de)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// Additional permission under GNU LGPL version 3 section 4 and 5
+// If you modify this Program, or any covered work, by linking or combining
+// it with ArcGIS Runtime for Qt (or a modified version of that library),
+// containing parts covered by the terms of ArcGIS Runtime for Qt,
+// the licensors of this Program grant you additional permission to convey the resulting work.
+// See <https://developers.arcgis.com/qt/> for further information.
+//
+#ifndef STREAMDECOMPRESSOR_H
+#define STREAMDECOMPRESSOR_H
+
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QString>
+
+#include <functional>
+
+// Incremental decompression of gzip, zlib, raw deflate and zstd payloads.
+// The compressed bytes are inflated into blocks of a fixed size as they arrive,
+// every block is handed over before the next one is inflated, so the inflated
+// document is never held in memory. Zstandard needs the app being built with zstd.
+class StreamDecompressor
+{
+public:
+    enum class Encoding
+    {
+        Identity,
+        Gzip,
+        Deflate,
+        Zstd,
+        Unsupported
+    };
+
+    typedef std::function<void(const char* data, int size)> Consumer;
+
+    explicit StreamDecompressor(Encoding encoding);
+    ~StreamDecompressor();
+
+    Encoding encoding() const;
+
+    bool decompress(const char* data, int size, const Consumer& consume);
+
+    bool atEnd() const;
+
+    QString errorString() const;
+
+    static Encoding encodingOf(const QByteArray& contentEncoding);
+    static Encoding detectEncoding(const QByteArray& leadingBytes);
+    static bool isSupported(Encoding encoding);
+    static QByteArray acceptEncoding();
+
+private:
+    Q_DISABLE_COPY(StreamDecompressor)
+
+    struct State;
+
+    bool inflateData(const char* data, int size, const Consumer& consume);
+    bool decompressZstd(const char* data, int size, const Consumer& consume);
+
+    Encoding m_encoding = Encoding::Identity;
+    QScopedPointer<State> m_state;
+    bool m_atEnd = false;
+    QString m_errorString;
+};
+
+#endif // STREAMDECOMPRESSOR_H
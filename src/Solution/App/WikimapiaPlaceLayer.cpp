@@ -23,6 +23,9 @@
 //
 #include "WikimapiaPlaceLayer.h"
 
+#include "FeatureParsePipeline.h"
+#include "ResponseCache.h"
+
 #include "Envelope.h"
 #include "FeatureCollectionTable.h"
 #include "GeometryEngine.h"
@@ -47,10 +50,12 @@ using namespace Esri::ArcGISRuntime;
 WikimapiaPlaceLayer::WikimapiaPlaceLayer(QObject *parent) :
     QObject(parent),
     m_networkAccessManager(new QNetworkAccessManager(this)),
+    m_parsePipeline(new FeatureParsePipeline(this)),
     m_overlay(new GraphicsOverlay(this)),
     m_labelOverlay(new GraphicsOverlay(this))
 {
     connect(m_networkAccessManager, &QNetworkAccessManager::finished, this, &WikimapiaPlaceLayer::networkRequestFinished);
+    connect(m_parsePipeline, &FeatureParsePipeline::featuresParsed, this, &WikimapiaPlaceLayer::featuresParsed);
     QProcessEnvironment systemEnvironment = QProcessEnvironment::systemEnvironment();
     QString licenseKeyName = "wikimapia.key";
     if (systemEnvironment.contains(licenseKeyName))
@@ -69,6 +74,11 @@ WikimapiaPlaceLayer::WikimapiaPlaceLayer(QObject *parent) :
     m_labelOverlay->setMinScale(5e4);
 }
 
+void WikimapiaPlaceLayer::setResponseCache(ResponseCache *responseCache)
+{
+    m_responseCache = responseCache;
+}
+
 void WikimapiaPlaceLayer::setSpatialFilter(const Esri::ArcGISRuntime::Envelope &extent)
 {
     m_spatialFilter = extent;
@@ -128,11 +138,34 @@ void WikimapiaPlaceLayer::query()
 
     QNetworkRequest wikiMapiaRequest;
     wikiMapiaRequest.setUrl(wikimapiaQueryUrl);
-    m_networkAccessManager->get(wikiMapiaRequest);
+    quint64 generation = m_parsePipeline->supersede();
+
+    QByteArray cachedResponse;
+    if (m_responseCache && m_responseCache->lookup("wikimapia", wikimapiaQueryUrl, cachedResponse))
+    {
+        parseResponse(generation, cachedResponse);
+        return;
+    }
+    if (m_responseCache && m_responseCache->isCacheOnly())
+    {
+        qDebug() << "Wikimapia query is not cached!";
+        return;
+    }
+
+    m_parsePipeline->trackRequest(wikiMapiaRequest, generation);
+    m_parsePipeline->trackReply(m_networkAccessManager->get(wikiMapiaRequest));
 }
 
 void WikimapiaPlaceLayer::networkRequestFinished(QNetworkReply *reply)
 {
+    reply->deleteLater();
+    quint64 generation = FeatureParsePipeline::requestGeneration(reply);
+    if (!m_parsePipeline->isCurrent(generation))
+    {
+        // Superseded by a newer query
+        return;
+    }
+
     if (reply->error())
     {
         qDebug() << reply->errorString();
@@ -140,22 +173,68 @@ void WikimapiaPlaceLayer::networkRequestFinished(QNetworkReply *reply)
     }
 
     QByteArray jsonResponse = reply->readAll();
-    QJsonDocument wikiMapiaEventsDocument = QJsonDocument::fromJson(jsonResponse);
+    if (m_responseCache)
+    {
+        m_responseCache->insert("wikimapia", reply->request().url(), jsonResponse);
+    }
+    parseResponse(generation, jsonResponse);
+}
+
+void WikimapiaPlaceLayer::parseResponse(quint64 generation, const QByteArray &jsonResponse)
+{
+    m_parsePipeline->submit(generation, [jsonResponse](const CancelCheck& isCanceled)
+    {
+        return parsePlaces(jsonResponse, isCanceled);
+    });
+}
+
+void WikimapiaPlaceLayer::featuresParsed(quint64 generation, const ParsedFeatureList &features)
+{
+    Q_UNUSED(generation);
+    QList<Graphic*> wikimapiaGraphics;
+    foreach (const ParsedFeature& feature, features)
+    {
+        Graphic* wikimapiaGraphic = new Graphic(feature.geometry, feature.attributes, this);
+        wikimapiaGraphics.append(wikimapiaGraphic);
+
+        /*
+        Point wikimapiaPoint = GeometryEngine::labelPoint(wikimapiaPolygon);
+        TextSymbol* wikimapiaTextSymbol = new TextSymbol(wikimapiaEventName, Qt::black, 15, HorizontalAlignment::Center, VerticalAlignment::Middle, this);
+        Graphic* wikimapiaTextGraphic = new Graphic(wikimapiaPoint, wikimapiaTextSymbol, this);
+        m_labelOverlay->graphics()->append(wikimapiaTextGraphic);
+        */
+    }
+
+    if (!wikimapiaGraphics.isEmpty())
+    {
+        m_overlay->graphics()->append(wikimapiaGraphics);
+    }
+}
+
+ParsedFeatureList WikimapiaPlaceLayer::parsePlaces(const QByteArray &json, const CancelCheck &isCanceled)
+{
+    QJsonDocument wikiMapiaEventsDocument = QJsonDocument::fromJson(json);
     if (wikiMapiaEventsDocument.isNull())
     {
         qDebug() << "JSON is invalid!";
-        return;
+        return ParsedFeatureList();
     }
     if (!wikiMapiaEventsDocument.isObject())
     {
         qDebug() << "JSON document is not an object!";
-        return;
+        return ParsedFeatureList();
     }
 
+    ParsedFeatureList places;
     QJsonObject wikimapiaEventsObject = wikiMapiaEventsDocument.object();
     QJsonArray wikimapiaEventsArray = wikimapiaEventsObject["folder"].toArray();
     foreach (const QJsonValue& wikimapiaEvent, wikimapiaEventsArray)
     {
+        if (isCanceled())
+        {
+            return ParsedFeatureList();
+        }
+
         if (wikimapiaEvent.isObject())
         {
             QJsonObject wikimapiaEventRecord = wikimapiaEvent.toObject();
@@ -174,22 +253,13 @@ void WikimapiaPlaceLayer::networkRequestFinished(QNetworkReply *reply)
                     }
                 }
 
-                Polygon wikimapiaPolygon = polygonBuilder.toPolygon();
-                Graphic* wikimapiaGraphic = new Graphic(wikimapiaPolygon, this);
-                m_overlay->graphics()->append(wikimapiaGraphic);
-
-                QString wikimapiaEventName = wikimapiaEventRecord["name"].toString();
-                QString wikimapiaUrl = wikimapiaEventRecord["url"].toString();
-                wikimapiaGraphic->attributes()->insertAttribute("name", wikimapiaEventName);
-                wikimapiaGraphic->attributes()->insertAttribute("url", wikimapiaUrl);
-
-                /*
-                Point wikimapiaPoint = GeometryEngine::labelPoint(wikimapiaPolygon);
-                TextSymbol* wikimapiaTextSymbol = new TextSymbol(wikimapiaEventName, Qt::black, 15, HorizontalAlignment::Center, VerticalAlignment::Middle, this);
-                Graphic* wikimapiaTextGraphic = new Graphic(wikimapiaPoint, wikimapiaTextSymbol, this);
-                m_labelOverlay->graphics()->append(wikimapiaTextGraphic);
-                */
+                QVariantMap wikimapiaAttributes;
+                wikimapiaAttributes.insert("name", wikimapiaEventRecord["name"].toString());
+                wikimapiaAttributes.insert("url", wikimapiaEventRecord["url"].toString());
+                places.append({ polygonBuilder.toPolygon(), wikimapiaAttributes });
             }
         }
     }
+
+    return places;
 }
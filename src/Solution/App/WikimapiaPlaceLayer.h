@@ -25,6 +25,7 @@
 #define WIKIMAPIAPLACELAYER_H
 
 #include "Envelope.h"
+#include "ParsedFeature.h"
 
 namespace Esri
 {
@@ -37,6 +38,8 @@ class Renderer;
 }
 }
 
+class FeatureParsePipeline;
+class ResponseCache;
 class QNetworkReply;
 
 #include <QNetworkAccessManager>
@@ -48,6 +51,8 @@ class WikimapiaPlaceLayer : public QObject
 public:
     explicit WikimapiaPlaceLayer(QObject *parent = nullptr);
 
+    void setResponseCache(ResponseCache* responseCache);
+
     void setSpatialFilter(const Esri::ArcGISRuntime::Envelope &extent);
 
     Esri::ArcGISRuntime::GraphicsOverlay* overlay() const;
@@ -59,9 +64,16 @@ signals:
 
 private slots:
     void networkRequestFinished(QNetworkReply* reply);
+    void featuresParsed(quint64 generation, const ParsedFeatureList& features);
 
 private:
+    static ParsedFeatureList parsePlaces(const QByteArray& json, const CancelCheck& isCanceled);
+
+    void parseResponse(quint64 generation, const QByteArray& jsonResponse);
+
     QNetworkAccessManager* m_networkAccessManager = nullptr;
+    FeatureParsePipeline* m_parsePipeline = nullptr;
+    ResponseCache* m_responseCache = nullptr;
     QString m_wikimapiaLicenseKey;
 
     Esri::ArcGISRuntime::GraphicsOverlay* m_overlay = nullptr;
@@ -23,6 +23,10 @@ Item {
         model.activateSimpleRendering();
     }
 
+    function activateClusterRendering() {
+        model.activateClusterRendering();
+    }
+
     function activateHeatmapRendering() {
         model.activateHeatmapRendering();
     }
@@ -43,6 +47,14 @@ Item {
         model.queryGdelt(queryText, useExtent);
     }
 
+    function startLiveMonitoring(queryText, useExtent) {
+        model.startLiveMonitoring(queryText, useExtent);
+    }
+
+    function stopLiveMonitoring() {
+        model.stopLiveMonitoring();
+    }
+
     function clearGeoJson() {
         model.clearGeoJson();
     }
@@ -55,6 +67,14 @@ Item {
         model.queryNominatim(queryText);
     }
 
+    function suggestPlaces(text) {
+        model.suggestPlaces(text);
+    }
+
+    function selectPlaceSuggestion(index) {
+        model.selectPlaceSuggestion(index);
+    }
+
     function nextPlace() {
         model.nextPlace();
     }
@@ -71,9 +91,14 @@ Item {
         model.clearWikimapia();
     }
 
+    function setCacheOnly(enabled) {
+        model.cacheOnly = enabled;
+    }
+
     signal mapNotification(string message);
     signal calloutDataChanged(var calloutData);
     signal wikimapiaStateChanged(bool enabled);
+    signal placeSuggestionsChanged(var suggestions);
 
     // Create MapQuickView here, and create its Map etc. in C++ code
     MapView {
@@ -140,5 +165,25 @@ Item {
         onWikimapiaStateChanged: {
             mapForm.wikimapiaStateChanged(model.queryWikimapiaEnabled);
         }
+
+        onGeoJsonLoadProgressChanged: {
+            if (0 === model.geoJsonLoadProgress % 10) {
+                mapForm.mapNotification("Loading GeoJSON " + model.geoJsonLoadProgress + " %");
+            }
+        }
+
+        onPlaceSuggestionsChanged: {
+            mapForm.placeSuggestionsChanged(model.placeSuggestions);
+        }
+
+        onGeocodeProgressChanged: {
+            mapForm.mapNotification(model.geocodeProgress);
+        }
+
+        onNewEventCountChanged: {
+            if (model.liveMonitoring) {
+                mapForm.mapNotification(model.newEventCount + " new events since last refresh");
+            }
+        }
     }
 }
@@ -36,7 +36,7 @@ ApplicationWindow {
             RowLayout {
 
                 ButtonGroup {
-                    buttons: [simpleButton, heatButton]
+                    buttons: [simpleButton, clusterButton, heatButton]
                 }
 
                 RadioButton {
@@ -48,6 +48,14 @@ ApplicationWindow {
                     }
                 }
 
+                RadioButton {
+                    id: clusterButton
+                    text: qsTr("Cluster")
+                    onClicked: {
+                        monitorForm.activateClusterRendering();
+                    }
+                }
+
                 RadioButton {
                     id: heatButton
                     text: qsTr("Heat")
@@ -79,6 +87,18 @@ ApplicationWindow {
                     }
                 }
 
+                ToolButton {
+                    text: qsTr("Live")
+                    checkable: true
+                    onToggled: {
+                        if (checked) {
+                            monitorForm.startLiveMonitoring(queryText.text, false);
+                        } else {
+                            monitorForm.stopLiveMonitoring();
+                        }
+                    }
+                }
+
                 ToolButton {
                     text: qsTr("Clear")
                     onClicked: {
@@ -108,11 +128,39 @@ ApplicationWindow {
                     id: placeText
                     Layout.fillWidth: true
                     placeholderText: "<place name>"
+                    onTextEdited: {
+                        monitorForm.suggestPlaces(text);
+                    }
+
+                    Popup {
+                        id: suggestionPopup
+                        y: placeText.height
+                        width: placeText.width
+                        padding: 0
+
+                        ListView {
+                            id: suggestionListView
+                            width: suggestionPopup.availableWidth
+                            implicitHeight: contentHeight
+                            clip: true
+
+                            delegate: ItemDelegate {
+                                width: suggestionListView.width
+                                text: modelData.displayName
+                                onClicked: {
+                                    suggestionPopup.close();
+                                    placeText.text = modelData.displayName;
+                                    monitorForm.selectPlaceSuggestion(index);
+                                }
+                            }
+                        }
+                    }
                 }
 
                 ToolButton {
                     text: qsTr("Add to map")
                     onClicked: {
+                        suggestionPopup.close();
                         monitorForm.queryNominatim(placeText.text);
                     }
                 }
@@ -147,6 +195,14 @@ ApplicationWindow {
                     }
                 }
 
+                ToolButton {
+                    text: qsTr("Offline")
+                    checkable: true
+                    onToggled: {
+                        monitorForm.setCacheOnly(checked);
+                    }
+                }
+
                 ToolButton {
                     text: qsTr("Export map")
                     onClicked: {
@@ -212,6 +268,15 @@ ApplicationWindow {
             onWikimapiaStateChanged: {
                 findPlacesButton.enabled = enabled;
             }
+
+            onPlaceSuggestionsChanged: {
+                suggestionListView.model = suggestions;
+                if (0 < suggestions.length && placeText.activeFocus) {
+                    suggestionPopup.open();
+                } else {
+                    suggestionPopup.close();
+                }
+            }
         }
 
         ListView {
@@ -1,7 +1,7 @@
-QT += testlib
+QT += testlib concurrent network
 QT -= gui
 
-CONFIG += qt console warn_on depend_includepath testcase
+CONFIG += qt console warn_on depend_includepath testcase c++14
 CONFIG -= app_bundle
 
 TEMPLATE = app
@@ -9,4 +9,27 @@ TEMPLATE = app
 INCLUDEPATH += ../App/
 #include(../App/GEOINTMonitor.pri)
 
-SOURCES +=  tst_gdelttestsuite.cpp
+# The benchmarks parse GeoJSON into ArcGIS Runtime geometries
+ARCGIS_RUNTIME_VERSION = 100.4
+include(../App/arcgisruntime.pri)
+
+HEADERS += \
+    ../App/GazetteerIndex.h \
+    ../App/GdeltEventStore.h \
+    ../App/GeocodeCache.h \
+    ../App/GeoJsonBinaryCache.h \
+    ../App/GeometryPyramid.h \
+    ../App/GraphicsFactory.h \
+    ../App/ParsedFeature.h \
+    ../App/RequestScheduler.h \
+    ../App/ResponseCache.h
+
+SOURCES +=  tst_gdelttestsuite.cpp \
+    ../App/GazetteerIndex.cpp \
+    ../App/GdeltEventStore.cpp \
+    ../App/GeocodeCache.cpp \
+    ../App/GeoJsonBinaryCache.cpp \
+    ../App/GeometryPyramid.cpp \
+    ../App/GraphicsFactory.cpp \
+    ../App/RequestScheduler.cpp \
+    ../App/ResponseCache.cpp
@@ -1,6 +1,31 @@
 #include <QtTest>
 
-// add necessary includes here
+#include "GazetteerIndex.h"
+#include "GdeltEventStore.h"
+#include "GeocodeCache.h"
+#include "GeoJsonBinaryCache.h"
+#include "GraphicsFactory.h"
+#include "RequestScheduler.h"
+#include "ResponseCache.h"
+
+#include "Graphic.h"
+#include "GraphicsOverlay.h"
+#include "Point.h"
+#include "PolygonBuilder.h"
+#include "SpatialReference.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QThreadPool>
+
+#if defined(Q_OS_LINUX)
+#include <malloc.h>
+#endif
 
 class GDELTTestSuite : public QObject
 {
@@ -11,8 +36,34 @@ public:
     ~GDELTTestSuite();
 
 private slots:
-    void test_case1();
+    void test_responseCacheExpiry();
+    void test_responseCacheEviction();
+    void test_responseCacheNormalizedUrl();
+    void test_geocodeCacheNormalizedQuery_data();
+    void test_geocodeCacheNormalizedQuery();
+    void test_geocodeCacheEviction();
+    void test_geocodeCacheExpiry();
+    void test_requestSchedulerPriorities();
+    void test_requestSchedulerHold();
+    void test_requestSchedulerRetryDelay_data();
+    void test_requestSchedulerRetryDelay();
+    void benchmark_parseFeatures_data();
+    void benchmark_parseFeatures();
+    void benchmark_createGraphics_data();
+    void benchmark_createGraphics();
+    void benchmark_storeEvents();
+    void test_eventMemory();
+    void benchmark_gazetteer_data();
+    void benchmark_gazetteer();
+    void test_binaryCacheRoundTrip();
+    void test_binaryCacheCorruption_data();
+    void test_binaryCacheCorruption();
 
+private:
+    static QJsonArray createPolygonFeatures(int featureCount, int vertexCount);
+    static QString placeName(int placeIndex);
+    static ParsedFeatureList createCacheFeatures(int featureCount);
+    static qint64 allocatedBytes();
 };
 
 GDELTTestSuite::GDELTTestSuite()
@@ -25,11 +76,719 @@ GDELTTestSuite::~GDELTTestSuite()
 
 }
 
-void GDELTTestSuite::test_case1()
+void GDELTTestSuite::test_responseCacheExpiry()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    ResponseCache responseCache;
+    responseCache.setCacheDirectory(cacheDir.path());
+    responseCache.setTimeToLive("gdelt", 60);
+    QUrl url("https://api.gdeltproject.org/api/v2/geo/geo?query=flood&format=geojson");
+
+    // Sources without a time to live are not cached
+    QByteArray payload;
+    responseCache.insert("unknown", url, "{}");
+    QVERIFY(!responseCache.lookup("unknown", url, payload));
+
+    responseCache.insert("gdelt", url, "{\"features\":[]}");
+    QVERIFY(responseCache.lookup("gdelt", url, payload));
+    QCOMPARE(payload, QByteArray("{\"features\":[]}"));
+
+    // Entries stored before their time to live are expired, but still served offline
+    QStringList cacheFileNames = QDir(cacheDir.path()).entryList(QStringList() << "*.cache", QDir::Files);
+    QCOMPARE(cacheFileNames.count(), 1);
+    QFile cacheFile(cacheDir.filePath(cacheFileNames.first()));
+    QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+    QVERIFY(cacheFile.setFileTime(QDateTime::currentDateTimeUtc().addSecs(-120), QFileDevice::FileModificationTime));
+    cacheFile.close();
+    responseCache.setCacheOnly(true);
+    payload.clear();
+    QVERIFY(responseCache.lookup("gdelt", url, payload));
+    QCOMPARE(payload, QByteArray("{\"features\":[]}"));
+
+    responseCache.setCacheOnly(false);
+    QVERIFY(!responseCache.lookup("gdelt", url, payload));
+    QVERIFY(!QFile::exists(cacheFile.fileName()));
+}
+
+void GDELTTestSuite::test_responseCacheEviction()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    ResponseCache responseCache;
+    responseCache.setCacheDirectory(cacheDir.path());
+    responseCache.setTimeToLive("gdelt", 60);
+    responseCache.setMaximumSize(300);
+
+    // Every entry is accessed at its own time
+    QList<QUrl> urls;
+    for (int urlIndex = 0; urlIndex < 4; urlIndex++)
+    {
+        urls.append(QUrl(QString("https://api.gdeltproject.org/api/v2/geo/geo?query=q%1").arg(urlIndex)));
+    }
+    QByteArray payload;
+    responseCache.insert("gdelt", urls.at(0), QByteArray(100, 'a'));
+    QTest::qSleep(20);
+    responseCache.insert("gdelt", urls.at(1), QByteArray(100, 'b'));
+    QTest::qSleep(20);
+    responseCache.insert("gdelt", urls.at(2), QByteArray(100, 'c'));
+    QTest::qSleep(20);
+    QVERIFY(responseCache.lookup("gdelt", urls.at(0), payload));
+    QTest::qSleep(20);
+
+    // The least recently used entry is evicted once the maximum size is exceeded
+    responseCache.insert("gdelt", urls.at(3), QByteArray(100, 'd'));
+    QVERIFY(!responseCache.lookup("gdelt", urls.at(1), payload));
+    QVERIFY(responseCache.lookup("gdelt", urls.at(0), payload));
+    QVERIFY(responseCache.lookup("gdelt", urls.at(2), payload));
+    QVERIFY(responseCache.lookup("gdelt", urls.at(3), payload));
+    QCOMPARE(QDir(cacheDir.path()).entryList(QStringList() << "*.cache", QDir::Files).count(), 3);
+
+    // Payloads larger than the maximum size are never cached
+    responseCache.insert("gdelt", urls.at(1), QByteArray(400, 'b'));
+    QVERIFY(!responseCache.lookup("gdelt", urls.at(1), payload));
+    QVERIFY(responseCache.lookup("gdelt", urls.at(3), payload));
+}
+
+void GDELTTestSuite::test_responseCacheNormalizedUrl()
+{
+    // Scheme, host and the order of the query items do not matter
+    QCOMPARE(ResponseCache::normalizedUrl(QUrl("HTTPS://API.GdeltProject.org/api/v2/geo/geo?query=flood&format=geojson")),
+             ResponseCache::normalizedUrl(QUrl("https://api.gdeltproject.org/api/v2/geo/geo?format=geojson&query=flood")));
+    QVERIFY(ResponseCache::normalizedUrl(QUrl("https://api.gdeltproject.org/api/v2/geo/geo?query=flood"))
+            != ResponseCache::normalizedUrl(QUrl("https://api.gdeltproject.org/api/v2/geo/geo?query=fire")));
+}
+
+void GDELTTestSuite::test_geocodeCacheNormalizedQuery_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<QString>("normalizedQuery");
+    QTest::newRow("case") << "BERLIN" << "berlin";
+    QTest::newRow("whitespace") << "  New \t York  " << "new york";
+    QTest::newRow("punctuation") << "Frankfurt am Main, Germany" << "frankfurt am main germany";
+    QTest::newRow("diacritics") << QString::fromUtf8("São Paulo") << "sao paulo";
+    QTest::newRow("umlauts") << QString::fromUtf8("Köln") << "koln";
+    QTest::newRow("sharp s") << QString::fromUtf8("Straße") << "strasse";
+}
+
+void GDELTTestSuite::test_geocodeCacheNormalizedQuery()
+{
+    QFETCH(QString, query);
+    QFETCH(QString, normalizedQuery);
+    QCOMPARE(GeocodeCache::normalizedQuery(query), normalizedQuery);
+}
+
+void GDELTTestSuite::test_geocodeCacheEviction()
+{
+    using namespace Esri::ArcGISRuntime;
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    GeocodeCache geocodeCache;
+    geocodeCache.setCacheDirectory(cacheDir.path());
+    geocodeCache.setMaximumPointCount(2);
+
+    // Every result is a single point
+    ParsedFeatureList features;
+    features.append({ Point(13.4, 52.5, SpatialReference::wgs84()), QVariantMap(), QList<Geometry>() });
+    geocodeCache.insert("berlin", features, false);
+    geocodeCache.insert("berlin mitte", features, false);
+    ParsedFeatureList cachedFeatures;
+    QVERIFY(geocodeCache.lookup("berlin", cachedFeatures));
+    QCOMPARE(cachedFeatures.count(), 1);
+
+    // Cached queries complete their prefixes, the shorter ones first
+    QCOMPARE(geocodeCache.completions("ber", 8), QStringList() << "berlin" << "berlin mitte");
+    QCOMPARE(geocodeCache.completions("ber", 1), QStringList() << "berlin");
+
+    // The least recently used result is evicted once the maximum point count is exceeded
+    geocodeCache.insert("hamburg", features, false);
+    QVERIFY(!geocodeCache.lookup("berlin mitte", cachedFeatures));
+    QVERIFY(geocodeCache.lookup("berlin", cachedFeatures));
+    QVERIFY(geocodeCache.lookup("hamburg", cachedFeatures));
+}
+
+void GDELTTestSuite::test_geocodeCacheExpiry()
+{
+    using namespace Esri::ArcGISRuntime;
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    GeocodeCache geocodeCache;
+    geocodeCache.setCacheDirectory(cacheDir.path());
+    geocodeCache.setTimeToLive(60);
+
+    // The binary copy is written on the worker pool
+    ParsedFeatureList features;
+    QVariantMap attributes;
+    attributes.insert("display_name", "Berlin");
+    features.append({ Point(13.4, 52.5, SpatialReference::wgs84()), attributes, QList<Geometry>() });
+    geocodeCache.insert("berlin", features, true);
+    QThreadPool::globalInstance()->waitForDone();
+    GeoJsonBinaryCache::Source cachedSource = geocodeCache.open("berlin", false);
+    QVERIFY(cachedSource.isValid());
+    QCOMPARE(cachedSource.readFeatures(0, 1).first().attributes, attributes);
+    cachedSource = GeoJsonBinaryCache::Source();
+
+    // Expired copies are still served offline, but removed once they are opened online
+    geocodeCache.setTimeToLive(0);
+    QTest::qSleep(1100);
+    QVERIFY(geocodeCache.open("berlin", true).isValid());
+    QVERIFY(!geocodeCache.open("berlin", false).isValid());
+    QVERIFY(!geocodeCache.open("berlin", true).isValid());
+}
+
+void GDELTTestSuite::test_requestSchedulerPriorities()
+{
+    // Local file requests never reach the network
+    QTemporaryDir requestDir;
+    QVERIFY(requestDir.isValid());
+    QNetworkAccessManager networkAccessManager;
+    RequestScheduler scheduler(&networkAccessManager);
+    QSignalSpy sentSpy(&scheduler, &RequestScheduler::requestSent);
+    scheduler.setRate(2, 1);
+    auto request = [&requestDir](const QString& name)
+    {
+        return QNetworkRequest(QUrl::fromLocalFile(requestDir.filePath(name)));
+    };
+    auto sentUrl = [&sentSpy](int sentIndex)
+    {
+        return sentSpy.at(sentIndex).first().value<QNetworkReply*>()->request().url();
+    };
+
+    // The burst is sent at once, the other requests wait for their tokens
+    QTest::qWait(600);
+    QVERIFY(scheduler.enqueue(request("a"), RequestScheduler::NormalPriority));
+    QCOMPARE(sentSpy.count(), 1);
+    QVERIFY(scheduler.enqueue(request("b"), RequestScheduler::NormalPriority));
+    QVERIFY(scheduler.enqueue(request("c"), RequestScheduler::LowPriority));
+    QVERIFY(scheduler.enqueue(request("d"), RequestScheduler::HighPriority));
+    QCOMPARE(sentSpy.count(), 1);
+    QCOMPARE(scheduler.pendingCount(), 3);
+
+    // An identical pending request is not queued again, but takes the higher priority
+    QVERIFY(!scheduler.enqueue(request("b"), RequestScheduler::HighPriority));
+    QCOMPARE(scheduler.pendingCount(), 3);
+
+    QTRY_COMPARE_WITH_TIMEOUT(sentSpy.count(), 2, 2000);
+    QCOMPARE(sentUrl(1), request("d").url());
+    QTRY_COMPARE_WITH_TIMEOUT(sentSpy.count(), 3, 2000);
+    QCOMPARE(sentUrl(2), request("b").url());
+
+    // Canceled requests are never sent
+    QList<QNetworkRequest> canceledRequests = scheduler.cancel(RequestScheduler::LowPriority);
+    QCOMPARE(canceledRequests.count(), 1);
+    QCOMPARE(canceledRequests.first().url(), request("c").url());
+    QCOMPARE(scheduler.pendingCount(), 0);
+    QTest::qWait(1000);
+    QCOMPARE(sentSpy.count(), 3);
+}
+
+void GDELTTestSuite::test_requestSchedulerHold()
+{
+    QTemporaryDir requestDir;
+    QVERIFY(requestDir.isValid());
+    QNetworkAccessManager networkAccessManager;
+    RequestScheduler scheduler(&networkAccessManager);
+    QSignalSpy sentSpy(&scheduler, &RequestScheduler::requestSent);
+    scheduler.setRate(100, 10);
+
+    // Nothing is sent while the scheduler is held, a shorter hold does not end a longer one
+    QElapsedTimer holdTimer;
+    holdTimer.start();
+    scheduler.holdFor(500);
+    scheduler.holdFor(100);
+    QVERIFY(scheduler.enqueue(QNetworkRequest(QUrl::fromLocalFile(requestDir.filePath("a"))), RequestScheduler::HighPriority));
+    QVERIFY(scheduler.enqueue(QNetworkRequest(QUrl::fromLocalFile(requestDir.filePath("b"))), RequestScheduler::HighPriority));
+    QCOMPARE(sentSpy.count(), 0);
+    QTRY_COMPARE_WITH_TIMEOUT(sentSpy.count(), 2, 3000);
+    QVERIFY(450 <= holdTimer.elapsed());
+}
+
+void GDELTTestSuite::test_requestSchedulerRetryDelay_data()
+{
+    QDateTime retryTime = QDateTime::currentDateTimeUtc().addSecs(10);
+    QByteArray retryDate = QLocale::c().toString(retryTime, "ddd, dd MMM yyyy HH:mm:ss 'GMT'").toLatin1();
+    QTest::addColumn<QByteArray>("retryAfter");
+    QTest::addColumn<int>("attemptCount");
+    QTest::addColumn<int>("minimumDelay");
+    QTest::addColumn<int>("maximumDelay");
+    QTest::newRow("seconds") << QByteArray(" 30 ") << 1 << 30000 << 30000;
+    QTest::newRow("seconds beyond the maximum") << QByteArray("3600") << 1 << 60000 << 60000;
+    QTest::newRow("huge seconds") << QByteArray("99999999999") << 1 << 60000 << 60000;
+    QTest::newRow("negative seconds") << QByteArray("-5") << 1 << 0 << 0;
+    QTest::newRow("date") << retryDate << 1 << 8000 << 10000;
+    QTest::newRow("past date") << QByteArray("Wed, 21 Oct 2015 07:28:00 GMT") << 1 << 0 << 0;
+    QTest::newRow("first backoff") << QByteArray() << 1 << 2000 << 2000;
+    QTest::newRow("third backoff") << QByteArray() << 3 << 8000 << 8000;
+    QTest::newRow("maximum backoff") << QByteArray() << 10 << 60000 << 60000;
+    QTest::newRow("invalid header") << QByteArray("soon") << 2 << 4000 << 4000;
+}
+
+void GDELTTestSuite::test_requestSchedulerRetryDelay()
+{
+    QFETCH(QByteArray, retryAfter);
+    QFETCH(int, attemptCount);
+    QFETCH(int, minimumDelay);
+    QFETCH(int, maximumDelay);
+    int delay = RequestScheduler::retryDelay(retryAfter, attemptCount);
+    QVERIFY2(minimumDelay <= delay && delay <= maximumDelay, qPrintable(QString::number(delay)));
+}
+
+void GDELTTestSuite::benchmark_parseFeatures_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+    QTest::newRow("16 threads") << 16;
+}
+
+void GDELTTestSuite::benchmark_parseFeatures()
+{
+    QFETCH(int, threadCount);
+    const int featureCount = 20000;
+    QJsonArray featuresArray = createPolygonFeatures(featureCount, 64);
+
+    int maxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(threadCount);
+    ParsedFeatureList features;
+    QBENCHMARK
+    {
+        features = GraphicsFactory::parseFeatures(featuresArray, []() { return false; });
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(maxThreadCount);
+
+    // Merged in the original order
+    QCOMPARE(features.count(), featureCount);
+    QCOMPARE(features.first().attributes.value("index").toInt(), 0);
+    QCOMPARE(features.last().attributes.value("index").toInt(), featureCount - 1);
+}
+
+void GDELTTestSuite::benchmark_createGraphics_data()
+{
+    QTest::addColumn<bool>("bulkAppend");
+    QTest::newRow("per feature append") << false;
+    QTest::newRow("bulk append") << true;
+}
+
+void GDELTTestSuite::benchmark_createGraphics()
+{
+    using namespace Esri::ArcGISRuntime;
+
+    QFETCH(bool, bulkAppend);
+
+    // Points spread over the world like the events of a large GDELT query
+    const int featureCount = 50000;
+    ParsedFeatureList features;
+    for (int featureIndex = 0; featureIndex < featureCount; featureIndex++)
+    {
+        double x = -180 + 360.0 * featureIndex / featureCount;
+        double y = -60 + 120.0 * ((featureIndex * 7919) % featureCount) / featureCount;
+        QVariantMap attributes;
+        attributes.insert("index", featureIndex);
+        features.append({ Point(x, y, SpatialReference::wgs84()), attributes, QList<Geometry>() });
+    }
+
+    // Every iteration appends to empty overlays, one graphic at a time like before or all at once
+    int graphicCount = 0;
+    QBENCHMARK
+    {
+        GraphicsFactory graphicsFactory;
+        GraphicsOverlay pointsOverlay;
+        GraphicsOverlay linesOverlay;
+        GraphicsOverlay areasOverlay;
+        if (bulkAppend)
+        {
+            graphicsFactory.createGraphics(features, &pointsOverlay, &linesOverlay, &areasOverlay);
+        }
+        else
+        {
+            foreach (const ParsedFeature& feature, features)
+            {
+                pointsOverlay.graphics()->append(new Graphic(feature.geometry, feature.attributes, &graphicsFactory));
+            }
+        }
+        graphicCount = pointsOverlay.graphics()->size();
+    }
+
+    QCOMPARE(graphicCount, featureCount);
+}
+
+void GDELTTestSuite::benchmark_storeEvents()
+{
+    // Properties like the ones of the GDELT GEO API
+    const int eventCount = 50000;
+    QList<QVariantMap> propertyMaps;
+    for (int eventIndex = 0; eventIndex < eventCount; eventIndex++)
+    {
+        QVariantMap properties;
+        properties.insert("name", QString("Location %1").arg(eventIndex % 1000));
+        properties.insert("count", eventIndex % 17 + 1);
+        properties.insert("html", QString("<a href=\"https://example.org/news/%1\" title=\"News %1\">News %1</a>").arg(eventIndex));
+        propertyMaps.append(properties);
+    }
+
+    // Every iteration fills an empty store and ages out the older half, the dead front rows are compacted
+    int remainingCount = 0;
+    QBENCHMARK
+    {
+        GdeltEventStore events;
+        for (int eventIndex = 0; eventIndex < eventCount; eventIndex++)
+        {
+            events.append(eventIndex, eventIndex, propertyMaps.at(eventIndex), quint64(eventIndex + 1), eventIndex,
+                          QString("News %1").arg(eventIndex), QString());
+        }
+        for (qint64 eventId = events.firstEventId(); eventId < eventCount / 2; eventId++)
+        {
+            events.remove(eventId);
+        }
+        remainingCount = events.count();
+        QVERIFY(0 < events.firstEventId());
+        QCOMPARE(events.value(eventCount - 1, "html").toString(), propertyMaps.last().value("html").toString());
+    }
+
+    QCOMPARE(remainingCount, eventCount - eventCount / 2);
+}
+
+void GDELTTestSuite::test_eventMemory()
+{
+    if (allocatedBytes() < 0)
+    {
+        QSKIP("The allocated bytes are only measured with the GNU C library");
+    }
+
+    // The former layout kept one variant map per event converted from the parsed JSON properties,
+    // the graphic holding it is not even counted.
+    const int eventCount = 100000;
+    qint64 mapsStartBytes = allocatedBytes();
+    QList<QVariantMap> propertyMaps;
+    propertyMaps.reserve(eventCount);
+    for (int eventIndex = 0; eventIndex < eventCount; eventIndex++)
+    {
+        QJsonObject propertiesObject;
+        propertiesObject.insert("name", QString("Location %1").arg(eventIndex % 1000));
+        propertiesObject.insert("count", eventIndex % 17 + 1);
+        propertiesObject.insert("html", QString("<a href=\"https://example.org/news/%1\" title=\"News %1\">News %1</a>").arg(eventIndex));
+        propertyMaps.append(propertiesObject.toVariantMap());
+    }
+    qint64 mapsBytesPerEvent = (allocatedBytes() - mapsStartBytes) / eventCount;
+
+    // The store converts every map while appending, only the store itself remains allocated
+    qint64 storeStartBytes = allocatedBytes();
+    GdeltEventStore events;
+    for (int eventIndex = 0; eventIndex < eventCount; eventIndex++)
+    {
+        events.append(eventIndex, eventIndex, propertyMaps.at(eventIndex), quint64(eventIndex + 1), eventIndex,
+                      QString("News %1").arg(eventIndex), QString());
+    }
+    qint64 storeBytesPerEvent = (allocatedBytes() - storeStartBytes) / eventCount;
+
+    QTest::setBenchmarkResult(storeBytesPerEvent, QTest::BytesAllocated);
+    QVERIFY2(storeBytesPerEvent < mapsBytesPerEvent,
+             qPrintable(QString("%1 bytes per stored event, %2 bytes per variant map").arg(storeBytesPerEvent).arg(mapsBytesPerEvent)));
+    QCOMPARE(events.properties(eventCount - 1), propertyMaps.last());
+}
+
+void GDELTTestSuite::benchmark_gazetteer_data()
+{
+    QTest::addColumn<bool>("misspelled");
+    QTest::newRow("exact name") << false;
+    QTest::newRow("misspelled name") << true;
+}
+
+void GDELTTestSuite::benchmark_gazetteer()
+{
+    QFETCH(bool, misspelled);
+
+    // A GeoNames extract of generated places
+    const int placeCount = 50000;
+    QTemporaryDir extractDir;
+    QVERIFY(extractDir.isValid());
+    QString extractFilePath = extractDir.filePath("places.txt");
+    QFile extractFile(extractFilePath);
+    QVERIFY(extractFile.open(QIODevice::WriteOnly));
+    for (int placeIndex = 0; placeIndex < placeCount; placeIndex++)
+    {
+        QStringList columns;
+        columns << QString::number(1000000 + placeIndex) << placeName(placeIndex) << placeName(placeIndex) << QString()
+                << QString::number(-60 + 120.0 * placeIndex / placeCount) << QString::number(-180 + 360.0 * ((placeIndex * 7919) % placeCount) / placeCount)
+                << "P" << "PPL" << "DE" << QString() << QString() << QString() << QString() << QString()
+                << QString::number(placeIndex % 10000) << QString() << QString() << "Europe/Berlin" << "2020-01-01";
+        extractFile.write(columns.join('\t').toUtf8() + '\n');
+    }
+    extractFile.close();
+
+    QString indexFilePath = extractDir.filePath("places.gzix");
+    QVERIFY(GazetteerIndex::build(QStringList() << extractFilePath, indexFilePath));
+    GazetteerIndex gazetteer;
+    QVERIFY(gazetteer.open(indexFilePath));
+    QCOMPARE(gazetteer.placeCount(), placeCount);
+
+    // Exact names are looked up while geocoding, misspelled names only while suggesting
+    const int placeIndex = 12345;
+    QString normalizedName = GeocodeCache::normalizedQuery(placeName(placeIndex));
+    if (misspelled)
+    {
+        normalizedName[normalizedName.length() / 2] = 'x';
+    }
+    ParsedFeatureList features;
+    QList<quint32> placeIds;
+    QBENCHMARK
+    {
+        if (misspelled)
+        {
+            placeIds = gazetteer.similar(normalizedName, 8);
+        }
+        else
+        {
+            features = gazetteer.lookup(normalizedName, 8);
+        }
+    }
+
+    if (misspelled)
+    {
+        QVERIFY(gazetteer.lookup(normalizedName, 8).isEmpty());
+        QVERIFY(placeIds.contains(quint32(placeIndex)));
+    }
+    else
+    {
+        QVERIFY(!features.isEmpty());
+        QCOMPARE(features.first().attributes.value("place_id").toInt(), 1000000 + placeIndex);
+    }
+}
+
+void GDELTTestSuite::test_binaryCacheRoundTrip()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    GeoJsonBinaryCache binaryCache;
+    binaryCache.setCacheDirectory(cacheDir.path());
+
+    const int featureCount = 1000;
+    ParsedFeatureList features = createCacheFeatures(featureCount);
+    QString source = "https://example.org/places.geojson";
+    QVERIFY(binaryCache.validator(source).isEmpty());
+    QVERIFY(binaryCache.write(source, "etag:\"1\"", features));
+    QCOMPARE(binaryCache.validator(source), QString("etag:\"1\""));
+    {
+        // A copy is only opened with the validator it was written with
+        QVERIFY(!binaryCache.open(source, "etag:\"2\"").isValid());
+        GeoJsonBinaryCache::Source cachedSource = binaryCache.open(source, "etag:\"1\"");
+        QVERIFY(cachedSource.isValid());
+        QCOMPARE(cachedSource.featureCount(), featureCount);
+
+        bool valid = false;
+        ParsedFeatureList cachedFeatures = cachedSource.readFeatures(0, featureCount, &valid);
+        QVERIFY(valid);
+        QCOMPARE(cachedFeatures.count(), featureCount);
+
+        // The features are ordered by their location, the index attribute identifies them
+        QRectF cachedExtent = cachedSource.extent(0, featureCount);
+        QVector<bool> featuresRead(featureCount, false);
+        foreach (const ParsedFeature& cachedFeature, cachedFeatures)
+        {
+            int featureIndex = cachedFeature.attributes.value("index").toInt();
+            QVERIFY(0 <= featureIndex && featureIndex < featureCount);
+            QVERIFY(!featuresRead.at(featureIndex));
+            featuresRead[featureIndex] = true;
+
+            const ParsedFeature& feature = features.at(featureIndex);
+            QCOMPARE(cachedFeature.attributes, feature.attributes);
+            QCOMPARE(cachedFeature.geometry.geometryType(), feature.geometry.geometryType());
+            QCOMPARE(cachedFeature.levels.count(), feature.levels.count());
+            Esri::ArcGISRuntime::Envelope featureExtent = feature.geometry.extent();
+            Esri::ArcGISRuntime::Envelope cachedFeatureExtent = cachedFeature.geometry.extent();
+            QCOMPARE(cachedFeatureExtent.xMin(), featureExtent.xMin());
+            QCOMPARE(cachedFeatureExtent.yMin(), featureExtent.yMin());
+            QCOMPARE(cachedFeatureExtent.xMax(), featureExtent.xMax());
+            QCOMPARE(cachedFeatureExtent.yMax(), featureExtent.yMax());
+            QVERIFY(cachedExtent.contains(QPointF(featureExtent.xMin(), featureExtent.yMin())));
+            QVERIFY(cachedExtent.contains(QPointF(featureExtent.xMax(), featureExtent.yMax())));
+        }
+    }
+
+    // A new validator replaces the copy of the former one
+    QVERIFY(binaryCache.write(source, "etag:\"2\"", features.mid(0, 10)));
+    QCOMPARE(binaryCache.validator(source), QString("etag:\"2\""));
+    QVERIFY(!binaryCache.open(source, "etag:\"1\"").isValid());
+    QCOMPARE(binaryCache.open(source, "etag:\"2\"").featureCount(), 10);
+    QCOMPARE(QDir(cacheDir.path()).entryList(QStringList() << "*.gjb", QDir::Files).count(), 1);
+
+    binaryCache.remove(source);
+    QVERIFY(binaryCache.validator(source).isEmpty());
+    QVERIFY(!binaryCache.open(source, "etag:\"2\"").isValid());
+
+    // Local files are validated by their size and modification time
+    QString filePath = cacheDir.filePath("places.geojson");
+    QVERIFY(GeoJsonBinaryCache::fileValidator(filePath).isEmpty());
+    QFile localFile(filePath);
+    QVERIFY(localFile.open(QIODevice::WriteOnly));
+    localFile.write("{}");
+    localFile.close();
+    QString fileValidator = GeoJsonBinaryCache::fileValidator(filePath);
+    QVERIFY(!fileValidator.isEmpty());
+    QVERIFY(localFile.open(QIODevice::Append));
+    localFile.write(" ");
+    localFile.close();
+    QVERIFY(fileValidator != GeoJsonBinaryCache::fileValidator(filePath));
+}
+
+void GDELTTestSuite::test_binaryCacheCorruption_data()
+{
+    // The header position of the corrupted section or zero for the header itself, the corrupted offset within
+    QTest::addColumn<int>("sectionField");
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<bool>("truncated");
+    QTest::addColumn<bool>("openable");
+    QTest::newRow("truncated file") << 0 << 0 << true << false;
+    QTest::newRow("corrupted magic") << 0 << 0 << false << false;
+    QTest::newRow("corrupted section position") << 0 << 56 << false << false;
+    QTest::newRow("corrupted string offset") << 24 << 4 << false << true;
+    QTest::newRow("corrupted record offset") << 56 << 8 << false << true;
+    QTest::newRow("corrupted part count") << 64 << 8 << false << true;
+    QTest::newRow("corrupted string id") << 72 << 0 << false << true;
+}
+
+void GDELTTestSuite::test_binaryCacheCorruption()
+{
+    QFETCH(int, sectionField);
+    QFETCH(int, offset);
+    QFETCH(bool, truncated);
+    QFETCH(bool, openable);
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    GeoJsonBinaryCache binaryCache;
+    binaryCache.setCacheDirectory(cacheDir.path());
+    QString source = "https://example.org/places.geojson";
+    QString validator = "etag:\"1\"";
+    QVERIFY(binaryCache.write(source, validator, createCacheFeatures(100)));
+
+    QStringList cacheFileNames = QDir(cacheDir.path()).entryList(QStringList() << "*.gjb", QDir::Files);
+    QCOMPARE(cacheFileNames.count(), 1);
+    QFile cacheFile(cacheDir.filePath(cacheFileNames.first()));
+    QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+    if (truncated)
+    {
+        QVERIFY(cacheFile.resize(cacheFile.size() / 2));
+    }
+    else
+    {
+        // Every bit of the 32-bit value at the position is set
+        QByteArray header = cacheFile.read(80);
+        QCOMPARE(header.size(), 80);
+        qint64 sectionPosition = (0 == sectionField) ? 0 : qint64(qFromLittleEndian<quint64>(header.constData() + sectionField));
+        QVERIFY(cacheFile.seek(sectionPosition + offset));
+        QCOMPARE(cacheFile.write(QByteArray(4, char(0xff))), qint64(4));
+    }
+    cacheFile.close();
+
+    // Corrupted copies are rejected when opened or when their features are read
+    GeoJsonBinaryCache::Source cachedSource = binaryCache.open(source, validator);
+    QCOMPARE(cachedSource.isValid(), openable);
+    if (openable)
+    {
+        bool valid = true;
+        ParsedFeatureList cachedFeatures = cachedSource.readFeatures(0, cachedSource.featureCount(), &valid);
+        QVERIFY(!valid);
+        QVERIFY(cachedFeatures.isEmpty());
+    }
+}
+
+ParsedFeatureList GDELTTestSuite::createCacheFeatures(int featureCount)
+{
+    using namespace Esri::ArcGISRuntime;
+
+    // Points and squares with one generalized level spread over the world
+    ParsedFeatureList features;
+    for (int featureIndex = 0; featureIndex < featureCount; featureIndex++)
+    {
+        double x = -180 + 360.0 * featureIndex / featureCount;
+        double y = -60 + 120.0 * ((featureIndex * 7919) % featureCount) / featureCount;
+        QVariantMap attributes;
+        attributes.insert("index", featureIndex);
+        attributes.insert("name", QString("Place %1").arg(featureIndex));
+        attributes.insert("value", 0.1 * featureIndex);
+        if (0 == featureIndex % 4)
+        {
+            PolygonBuilder polygonBuilder(SpatialReference::wgs84());
+            polygonBuilder.addPoint(x, y);
+            polygonBuilder.addPoint(x + 0.1, y);
+            polygonBuilder.addPoint(x + 0.1, y + 0.1);
+            polygonBuilder.addPoint(x, y + 0.1);
+            Geometry square = polygonBuilder.toGeometry();
+            features.append({ square, attributes, QList<Geometry>() << square });
+        }
+        else
+        {
+            features.append({ Point(x, y, SpatialReference::wgs84()), attributes, QList<Geometry>() });
+        }
+    }
+    return features;
+}
+
+QString GDELTTestSuite::placeName(int placeIndex)
+{
+    // Every place index has its own combination of four syllables
+    static const QStringList syllables = QStringList() << "ber" << "lin" << "ham" << "burg" << "mun" << "chen" << "kol"
+                                                       << "dorf" << "stadt" << "feld" << "wald" << "heim" << "bach" << "au" << "see";
+    QString name;
+    for (int syllableIndex = 0, index = placeIndex; syllableIndex < 4; syllableIndex++, index /= syllables.count())
+    {
+        name += syllables.at(index % syllables.count());
+    }
+    name[0] = name.at(0).toUpper();
+    return name;
+}
+
+qint64 GDELTTestSuite::allocatedBytes()
+{
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+    // Heap and memory mapped bytes in use
+    struct mallinfo allocationInfo = mallinfo();
+    return qint64(allocationInfo.uordblks) + qint64(allocationInfo.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+QJsonArray GDELTTestSuite::createPolygonFeatures(int featureCount, int vertexCount)
 {
+    QJsonArray featuresArray;
+    for (int featureIndex = 0; featureIndex < featureCount; featureIndex++)
+    {
+        // Regular polygons around the features locations
+        double centerX = -180 + 360.0 * featureIndex / featureCount;
+        double centerY = -60 + 120.0 * ((featureIndex * 7919) % featureCount) / featureCount;
+        QJsonArray ringArray;
+        for (int vertexIndex = 0; vertexIndex <= vertexCount; vertexIndex++)
+        {
+            double angle = 2 * M_PI * vertexIndex / vertexCount;
+            QJsonArray vertexArray;
+            vertexArray.append(centerX + 0.01 * qCos(angle));
+            vertexArray.append(centerY + 0.01 * qSin(angle));
+            ringArray.append(vertexArray);
+        }
+        QJsonArray coordinatesArray;
+        coordinatesArray.append(ringArray);
 
+        QJsonObject geometryObject;
+        geometryObject.insert("type", "Polygon");
+        geometryObject.insert("coordinates", coordinatesArray);
+        QJsonObject propertiesObject;
+        propertiesObject.insert("index", featureIndex);
+        propertiesObject.insert("name", QString("Area %1").arg(featureIndex));
+        QJsonObject featureObject;
+        featureObject.insert("type", "Feature");
+        featureObject.insert("geometry", geometryObject);
+        featureObject.insert("properties", propertiesObject);
+        featuresArray.append(featureObject);
+    }
+    return featuresArray;
 }
 
-QTEST_APPLESS_MAIN(GDELTTestSuite)
+QTEST_GUILESS_MAIN(GDELTTestSuite)
 
 #include "tst_gdelttestsuite.moc"